@@ -0,0 +1,31 @@
+#-------------------------------------------------
+#
+# Project created by QtCreator 2016-08-20T15:08:43
+#
+#-------------------------------------------------
+
+include( ../bindiff-qt.pri )
+
+TARGET = bindiff-qt
+
+TEMPLATE = app
+
+SOURCES += ../main.cpp\
+    ../mainwindow.cpp \
+    ../statisticsstrip.cpp \
+    ../statisticspanel.cpp
+
+HEADERS  += ../mainwindow.h \
+    ../statisticsstrip.h \
+    ../statisticspanel.h
+
+FORMS    += ../mainwindow.ui
+
+OTHER_FILES += ../license.txt
+
+INSTALLS += target
+
+unix{
+    target.path = /bin
+    message( The executable will be installed to $$target.path )
+}
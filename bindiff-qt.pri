@@ -0,0 +1,23 @@
+#-------------------------------------------------
+#
+# Parts shared by the application and its tests
+#
+#-------------------------------------------------
+
+QT       += core gui
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets concurrent
+
+*-g++*:QMAKE_CXXFLAGS += -Wall -Weffc++ -Wextra -Wconversion -Wsign-conversion -std=c++14
+
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+SOURCES += $$PWD/dualfileview.cpp \
+    $$PWD/blockhashtree.cpp \
+    $$PWD/viewlayout.cpp \
+    $$PWD/bytestatistics.cpp
+
+HEADERS += $$PWD/dualfileview.h \
+    $$PWD/blockhashtree.h \
+    $$PWD/viewlayout.h \
+    $$PWD/bytestatistics.h
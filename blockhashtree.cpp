@@ -0,0 +1,192 @@
+//*****************************************************************************
+//
+//     blockhashtree.cpp
+//     Copyright(c) 2016 Juha T Nikkanen <nikkej@gmail.com>
+//
+// --- Legal stuff ---
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//*****************************************************************************
+
+#include "blockhashtree.h"
+
+#include <QtConcurrent>
+#include <cstring>
+
+namespace {
+
+const quint64 prime1 = 0x9e3779b185ebca87ULL;
+const quint64 prime2 = 0xc2b2ae3d27d4eb4fULL;
+const quint64 prime3 = 0x165667b19e3779f9ULL;
+
+// # of blocks hashed by one concurrent job, keeps scheduling overhead low
+const int blocksPerJob = 64;
+
+inline quint64 rotl( const quint64 v, const int r )
+{
+    return ( v << r ) | ( v >> ( 64 - r ) );
+}
+
+inline quint64 readWord( const uchar* p )
+{
+    quint64 w;
+    std::memcpy( &w, p, sizeof( w ) );
+    return w;
+}
+
+inline quint64 mixRound( quint64 acc, const quint64 w )
+{
+    acc += w * prime2;
+    return rotl( acc, 31 ) * prime1;
+}
+
+inline quint64 avalanche( quint64 h )
+{
+    h ^= h >> 33;
+    h *= prime2;
+    h ^= h >> 29;
+    h *= prime3;
+    h ^= h >> 32;
+    return h;
+}
+
+// Four independent lanes keep the multipliers busy, a single
+// lane would serialize on multiply latency
+quint64 hashBlock( const uchar* data, const qint64 length )
+{
+    const uchar* p = data;
+    const uchar* end = data + length;
+    quint64 acc[4] = { prime1 + prime2, prime2, 0, 0 - prime1 };
+
+    while( end - p >= 32 ) {
+        acc[0] = mixRound( acc[0], readWord( p ) );
+        acc[1] = mixRound( acc[1], readWord( p + 8 ) );
+        acc[2] = mixRound( acc[2], readWord( p + 16 ) );
+        acc[3] = mixRound( acc[3], readWord( p + 24 ) );
+        p += 32;
+    }
+
+    quint64 h = rotl( acc[0], 1 ) + rotl( acc[1], 7 ) + rotl( acc[2], 12 ) + rotl( acc[3], 18 );
+    h += static_cast<quint64>( length );
+
+    for( ; end - p >= 8; p += 8 )
+        h = rotl( h ^ mixRound( 0, readWord( p ) ), 27 ) * prime1 + prime3;
+    for( ; p < end; p++ )
+        h = rotl( h ^ ( static_cast<quint64>( *p ) * prime3 ), 11 ) * prime1;
+
+    return avalanche( h );
+}
+
+inline quint64 hashPair( const quint64 left, const quint64 right )
+{
+    return avalanche( mixRound( left, right ) ^ prime3 );
+}
+
+} // namespace
+
+BlockHashTree::BlockHashTree()
+    : _levels(),
+      _size( 0 ),
+      _blockSize( BlockHashTree::defaultBlockSize )
+{
+}
+
+void BlockHashTree::build( const uchar* data, const qint64 size, const int blockSize )
+{
+    clear();
+
+    if( !data || size <= 0 || blockSize <= 0 )
+        return;
+
+    _size = size;
+    _blockSize = blockSize;
+
+    QVector<quint64> leaves( static_cast<int>( blockCount() ) );
+    QVector<qint64> jobs;
+    for( qint64 b( 0 ); b < leaves.size(); b += blocksPerJob )
+        jobs.append( b );
+
+    // Leaves are independent, hash them concurrently over the mmap
+    quint64* leaf = leaves.data();
+    QtConcurrent::blockingMap( jobs, [=]( const qint64 first ) {
+        const qint64 last = qMin( first + blocksPerJob, blockCount() );
+        for( qint64 b( first ); b < last; b++ ) {
+            const qint64 offset = b * _blockSize;
+            leaf[b] = hashBlock( data + offset, qMin( static_cast<qint64>( _blockSize ), _size - offset ) );
+        }
+    } );
+    _levels.append( leaves );
+
+    // Upper levels are tiny compared to leaf level, build them serially
+    while( _levels.last().size() > 1 ) {
+        const QVector<quint64>& below = _levels.last();
+        QVector<quint64> level( ( below.size() + 1 ) / 2 );
+        for( int n( 0 ); n < level.size(); n++ ) {
+            if( 2 * n + 1 < below.size() )
+                level[n] = hashPair( below.at( 2 * n ), below.at( 2 * n + 1 ) );
+            else
+                level[n] = hashPair( below.at( 2 * n ), 0 );
+        }
+        _levels.append( level );
+    }
+}
+
+void BlockHashTree::clear()
+{
+    _levels.clear();
+    _size = 0;
+}
+
+qint64 BlockHashTree::blockCount() const
+{
+    return ( _size + _blockSize - 1 ) / _blockSize;
+}
+
+QBitArray BlockHashTree::differingBlocks( const BlockHashTree& other ) const
+{
+    const qint64 blocks = qMax( blockCount(), other.blockCount() );
+
+    // Without comparable geometry every block has to be treated as differing
+    if( isEmpty() || other.isEmpty() || _blockSize != other._blockSize )
+        return QBitArray( static_cast<int>( blocks ), true );
+
+    QBitArray bits( static_cast<int>( blocks ) );
+    compare( other, qMax( _levels.size(), other._levels.size() ) - 1, 0, bits );
+    return bits;
+}
+
+void BlockHashTree::compare( const BlockHashTree& other, const int level, const qint64 index, QBitArray& bits ) const
+{
+    // Nodes missing from either tree cover data the other one doesn't have
+    if( hasNode( level, index ) && other.hasNode( level, index ) &&
+        _levels.at( level ).at( static_cast<int>( index ) ) == other._levels.at( level ).at( static_cast<int>( index ) ) )
+        return;
+
+    if( level == 0 ) {
+        bits.setBit( static_cast<int>( index ) );
+        return;
+    }
+
+    for( qint64 child( 2 * index ); child < 2 * index + 2; child++ ) {
+        if( ( child << ( level - 1 ) ) < bits.size() )
+            compare( other, level - 1, child, bits );
+    }
+}
+
+bool BlockHashTree::hasNode( const int level, const qint64 index ) const
+{
+    return level < _levels.size() && index < _levels.at( level ).size();
+}
@@ -0,0 +1,64 @@
+//*****************************************************************************
+//
+//     blockhashtree.h
+//     Copyright(c) 2016 Juha T Nikkanen <nikkej@gmail.com>
+//
+// --- Legal stuff ---
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//*****************************************************************************
+
+#ifndef BLOCKHASHTREE_H
+#define BLOCKHASHTREE_H
+
+#include <QBitArray>
+#include <QVector>
+
+// Binary hash tree over fixed size blocks of a mmap'ped file. Level 0 holds
+// one hash per block, each upper level one hash per pair of nodes below it,
+// so node (level, index) covers blocks [index << level, (index + 1) << level).
+// Two trees built with same block size share that geometry even if file
+// sizes differ, which makes top-down comparison skip identical subtrees.
+class BlockHashTree
+{
+public:
+    enum Constants {
+        defaultBlockSize = 64 * 1024
+    };
+
+    BlockHashTree();
+
+    void build( const uchar*, const qint64, const int blockSize = BlockHashTree::defaultBlockSize );
+    void clear();
+    inline bool isEmpty() const { return _levels.isEmpty(); }
+    inline int blockSize() const { return _blockSize; }
+    inline qint64 size() const { return _size; }
+    qint64 blockCount() const;
+
+    // Returns bit per block of the longer file, set where block content differs
+    QBitArray differingBlocks( const BlockHashTree& ) const;
+
+private: // Methods
+    void compare( const BlockHashTree&, const int, const qint64, QBitArray& ) const;
+    bool hasNode( const int, const qint64 ) const;
+
+private: // Data
+    QVector<QVector<quint64>> _levels;  // [0] == leaves, last == root
+    qint64        _size;               // # of bytes hashed
+    int           _blockSize;
+};
+
+#endif // BLOCKHASHTREE_H
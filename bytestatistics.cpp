@@ -0,0 +1,169 @@
+//*****************************************************************************
+//
+//     bytestatistics.cpp
+//     Copyright(c) 2016 Juha T Nikkanen <nikkej@gmail.com>
+//
+// --- Legal stuff ---
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//*****************************************************************************
+
+#include "bytestatistics.h"
+
+#include <QtConcurrent>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// # of blocks analyzed by one concurrent job, 1MB with default block size
+const int blocksPerJob = 256;
+
+// Counts go to four interleaved tables, so runs of equal bytes (padding,
+// zero fill) don't serialize on incrementing one and the same counter
+void countBytes( const uchar* data, const int length, quint32* counts )
+{
+    quint32 tables[4][256];
+    std::memset( tables, 0, sizeof( tables ) );
+
+    int n( 0 );
+    for( ; n + 4 <= length; n += 4 ) {
+        quint32 w;
+        std::memcpy( &w, data + n, sizeof( w ) );
+        tables[0][w & 0xff]++;
+        tables[1][( w >> 8 ) & 0xff]++;
+        tables[2][( w >> 16 ) & 0xff]++;
+        tables[3][w >> 24]++;
+    }
+    for( ; n < length; n++ )
+        tables[0][data[n]]++;
+
+    for( int v( 0 ); v < 256; v++ )
+        counts[v] = tables[0][v] + tables[1][v] + tables[2][v] + tables[3][v];
+}
+
+} // namespace
+
+ByteStatistics::ByteStatistics()
+    : _entropy(),
+      _zeroFill(),
+      _size( 0 ),
+      _blockSize( ByteStatistics::defaultBlockSize )
+{
+}
+
+void ByteStatistics::build( const uchar* data, const qint64 size, const int blockSize )
+{
+    clear();
+
+    if( !data || size <= 0 || blockSize <= 0 )
+        return;
+
+    _size = size;
+    _blockSize = blockSize;
+
+    const qint64 blocks = ( _size + _blockSize - 1 ) / _blockSize;
+    QVector<uchar> entropy( static_cast<int>( blocks ) );
+    QVector<uchar> zeroFill( static_cast<int>( blocks ) );
+
+    // Block entropy is log2( n ) - sum( c * log2( c ) ) / n,
+    // tabulate c * log2( c ) for every possible count c
+    QVector<double> cLogC( _blockSize + 1 );
+    for( int c( 1 ); c <= _blockSize; c++ )
+        cLogC[c] = c * std::log2( static_cast<double>( c ) );
+
+    QVector<qint64> jobs;
+    for( qint64 b( 0 ); b < blocks; b += blocksPerJob )
+        jobs.append( b );
+
+    uchar* entropyOut = entropy.data();
+    uchar* zeroFillOut = zeroFill.data();
+    const double* cLogCTable = cLogC.constData();
+    QtConcurrent::blockingMap( jobs, [=]( const qint64 first ) {
+        quint32 counts[256];
+        const qint64 last = qMin( first + blocksPerJob, blocks );
+        for( qint64 b( first ); b < last; b++ ) {
+            const qint64 offset = b * _blockSize;
+            const int length = static_cast<int>( qMin( static_cast<qint64>( _blockSize ), _size - offset ) );
+            countBytes( data + offset, length, counts );
+
+            double sum( 0 );
+            for( int v( 0 ); v < 256; v++ )
+                sum += cLogCTable[counts[v]];
+            const double bits = std::log2( static_cast<double>( length ) ) - sum / length;
+            entropyOut[b] = static_cast<uchar>( qBound( 0.0, bits / 8.0, 1.0 ) * ByteStatistics::maxValue + 0.5 );
+            zeroFillOut[b] = static_cast<uchar>( ( static_cast<qint64>( counts[0] ) * ByteStatistics::maxValue + length / 2 ) / length );
+        }
+    } );
+
+    _entropy.append( entropy );
+    _zeroFill.append( zeroFill );
+    addLevels( _entropy );
+    addLevels( _zeroFill );
+}
+
+void ByteStatistics::clear()
+{
+    _entropy.clear();
+    _zeroFill.clear();
+    _size = 0;
+}
+
+int ByteStatistics::levelFor( const qint64 bytes ) const
+{
+    int level( 0 );
+    while( level + 1 < levelCount() && ( static_cast<qint64>( _blockSize ) << ( level + 1 ) ) <= bytes )
+        level++;
+    return level;
+}
+
+uchar ByteStatistics::entropy( const int level, const qint64 offset ) const
+{
+    return valueAt( _entropy, level, offset, _blockSize );
+}
+
+uchar ByteStatistics::zeroFill( const int level, const qint64 offset ) const
+{
+    return valueAt( _zeroFill, level, offset, _blockSize );
+}
+
+void ByteStatistics::addLevels( QVector<QVector<uchar>>& levels )
+{
+    // Upper levels are tiny compared to block level, build them serially
+    while( levels.last().size() > 1 ) {
+        const QVector<uchar>& below = levels.last();
+        QVector<uchar> level( ( below.size() + 1 ) / 2 );
+        for( int n( 0 ); n < level.size(); n++ ) {
+            if( 2 * n + 1 < below.size() )
+                level[n] = static_cast<uchar>( ( below.at( 2 * n ) + below.at( 2 * n + 1 ) + 1 ) / 2 );
+            else
+                level[n] = below.at( 2 * n );
+        }
+        levels.append( level );
+    }
+}
+
+uchar ByteStatistics::valueAt( const QVector<QVector<uchar>>& levels, const int level, const qint64 offset, const int blockSize )
+{
+    if( level < 0 || level >= levels.size() || offset < 0 )
+        return 0;
+
+    const qint64 index = offset / ( static_cast<qint64>( blockSize ) << level );
+    if( index >= levels.at( level ).size() )
+        return 0;
+
+    return levels.at( level ).at( static_cast<int>( index ) );
+}
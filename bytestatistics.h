@@ -0,0 +1,66 @@
+//*****************************************************************************
+//
+//     bytestatistics.h
+//     Copyright(c) 2016 Juha T Nikkanen <nikkej@gmail.com>
+//
+// --- Legal stuff ---
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//*****************************************************************************
+
+#ifndef BYTESTATISTICS_H
+#define BYTESTATISTICS_H
+
+#include <QVector>
+
+// Per block Shannon entropy & zero fill ratio of a mmap'ped file, scaled
+// to 0..255. Like BlockHashTree, values are kept as a pyramid: level 0
+// holds one value per block and each upper level averages pairs of values
+// below it, so a view can pick the level matching its resolution.
+class ByteStatistics
+{
+public:
+    enum Constants {
+        defaultBlockSize = 4 * 1024,
+        maxValue = 255
+    };
+
+    ByteStatistics();
+
+    void build( const uchar*, const qint64, const int blockSize = ByteStatistics::defaultBlockSize );
+    void clear();
+    inline bool isEmpty() const { return _entropy.isEmpty(); }
+    inline int blockSize() const { return _blockSize; }
+    inline qint64 size() const { return _size; }
+    inline int levelCount() const { return _entropy.size(); }
+
+    // Finest level with at most one value per given # of bytes
+    int levelFor( const qint64 ) const;
+    uchar entropy( const int, const qint64 ) const;
+    uchar zeroFill( const int, const qint64 ) const;
+
+private: // Methods
+    static void addLevels( QVector<QVector<uchar>>& );
+    static uchar valueAt( const QVector<QVector<uchar>>&, const int, const qint64, const int );
+
+private: // Data
+    QVector<QVector<uchar>> _entropy;   // [0] == per block, last == whole file
+    QVector<QVector<uchar>> _zeroFill;
+    qint64        _size;
+    int           _blockSize;
+};
+
+#endif // BYTESTATISTICS_H
@@ -0,0 +1,509 @@
+//*****************************************************************************
+//
+//     dualfileview.cpp
+//     Copyright(c) 2016 Juha T Nikkanen <nikkej@gmail.com>
+//
+// --- Legal stuff ---
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//*****************************************************************************
+
+#include "dualfileview.h"
+
+#include <QDebug>
+#include <QObject>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QScrollBar>
+#include <QDragEnterEvent>
+#include <QDropEvent>
+#include <QMimeData>
+#include <QUrl>
+#include <QMenu>
+#include <QAction>
+#include <QActionGroup>
+#include <QHelpEvent>
+#include <QToolTip>
+#include <ctype.h>
+#include <climits>
+#include <cstring>
+
+DualFileView::DualFileView( QWidget* parent )
+    : QAbstractScrollArea( parent ),
+      _contextMenu( new QMenu( this ) ),
+      _contextAction( new QAction( tr( "&Open" ), this ) ),
+      _bytesPerLineActions( new QActionGroup( this ) ),
+      _bytesPerGroupActions( new QActionGroup( this ) ),
+      _displayUnitActions( new QActionGroup( this ) ),
+      _endiannessActions( new QActionGroup( this ) ),
+      _layout(),
+      _text(),
+      _fileName(),
+      _data(),
+      _size(),
+      _differingBlocks(),
+      _diffBlockSize( 1 ),
+      _frameDiff(),
+      _addend( 0 ),
+      _topLine( 0 ),
+      _lineCount( 0 ),
+      _linesOnPane( DualFileView::minimumOfLines ),
+      _linesPerStep( 1 ),
+      _contextPane( 0 ),
+      _vscrollBarWidth( 0 )
+{
+    _text.reserve( ViewLayout::maxTextChars );
+
+    _contextMenu->addAction( _contextAction );
+    _contextMenu->addSeparator();
+    addLayoutMenu( tr( "Bytes per &line" ), _bytesPerLineActions,
+                   { { tr( "&Fit to width" ), 0 }, { "8", 8 }, { "16", 16 }, { "24", 24 },
+                     { "32", 32 }, { "48", 48 }, { "64", 64 } } );
+    addLayoutMenu( tr( "Bytes per &group" ), _bytesPerGroupActions,
+                   { { "1", 1 }, { "2", 2 }, { "4", 4 }, { "8", 8 }, { "16", 16 } } );
+    addLayoutMenu( tr( "&Display as" ), _displayUnitActions,
+                   { { tr( "Hex bytes" ), ViewLayout::HexBytes },
+                     { tr( "16-bit words" ), ViewLayout::HexWords16 },
+                     { tr( "32-bit words" ), ViewLayout::HexWords32 },
+                     { tr( "64-bit words" ), ViewLayout::HexWords64 },
+                     { tr( "32-bit floats" ), ViewLayout::Floats32 },
+                     { tr( "64-bit floats" ), ViewLayout::Floats64 },
+                     { tr( "Binary" ), ViewLayout::BinaryBytes } } );
+    addLayoutMenu( tr( "Byte &order" ), _endiannessActions,
+                   { { tr( "Little endian" ), ViewLayout::LittleEndian },
+                     { tr( "Big endian" ), ViewLayout::BigEndian } } );
+    updateLayoutMenu();
+
+    connect( _contextAction, &QAction::triggered, [=](){ emit fileOpenRequested( _contextPane ); } );
+    connect( this, SIGNAL( customContextMenuRequested( const QPoint& ) ), \
+             this, SLOT( showContextMenu( const QPoint& ) ) );
+    setSizeAdjustPolicy( QAbstractScrollArea::AdjustToContents );
+    setSizePolicy( QSizePolicy::MinimumExpanding, QSizePolicy::MinimumExpanding );
+}
+
+DualFileView::~DualFileView()
+{
+}
+
+QSize DualFileView::viewportSizeHint() const
+{
+    return( QSize( _layout.preFitWidth( _layout.minimumOfByteGroups() ) + _vscrollBarWidth,
+                   DualFileView::panes * ( fontMetrics().height() * DualFileView::minimumOfLines + _layout.bottomMargin() ) ) );
+}
+
+void DualFileView::setFont( QFont font )
+{
+    if( !font.fixedPitch() ) {
+        font.setFixedPitch( true );
+    }
+
+    QWidget::setFont( font );
+
+    updateLayout();
+}
+
+void DualFileView::setData( const int pane, const uchar* data, const qint64 size )
+{
+    _data[pane] = data;
+    _size[pane] = size;
+
+    // Address field is wide enough for the larger file on both panes,
+    // highest address shown is size - 1
+    if( qMax( _size[0], _size[1] ) - 1 > UINT_MAX )
+        _layout.setAddressCharacters( 16 );
+    else
+        _layout.setAddressCharacters( 8 );
+
+    updateLayout();
+}
+
+void DualFileView::setFileName( const int pane, const QString& fileName )
+{
+    _fileName[pane] = fileName;
+}
+
+void DualFileView::setDifferingBlocks( const QBitArray& blocks, const int blockSize )
+{
+    _differingBlocks = blocks;
+    _diffBlockSize = qMax( 1, blockSize );
+    viewport()->update();
+}
+
+qint64 DualFileView::addressAddend()
+{
+    return qBound( static_cast<qint64>( 0 ), _topLine, maxTopLine() ) * _layout.bytesPerLine();
+}
+
+void DualFileView::scrollToAddress( const qint64 addr )
+{
+    setTopLine( addr / _layout.bytesPerLine() );
+}
+
+void DualFileView::setBytesPerLine( const int bytes )
+{
+    _layout.setBytesPerLine( bytes );
+    updateLayout();
+    updateLayoutMenu();
+}
+
+void DualFileView::setBytesPerGroup( const int bytes )
+{
+    _layout.setBytesPerGroup( bytes );
+    updateLayout();
+    updateLayoutMenu();
+}
+
+void DualFileView::setDisplayUnit( const ViewLayout::DisplayUnit unit )
+{
+    _layout.setDisplayUnit( unit );
+    updateLayout();
+    updateLayoutMenu();
+}
+
+void DualFileView::setEndianness( const ViewLayout::Endianness endianness )
+{
+    _layout.setEndianness( endianness );
+    updateLayoutMenu();
+    viewport()->update();
+}
+
+QRect DualFileView::paneRect( const int pane ) const
+{
+    const QRect area = viewport()->geometry();
+    return( QRect( area.left(), area.top() + pane * paneHeight(), area.width(), paneHeight() ) );
+}
+
+void DualFileView::showContextMenu( const QPoint& pos )
+{
+    // Position is in viewport's coordinates, as for all scroll areas
+    _contextPane = paneAt( pos.y() );
+    _contextMenu->exec( viewport()->mapToGlobal( pos ) );
+}
+
+void DualFileView::dragEnterEvent( QDragEnterEvent* event )
+{
+    if( event->mimeData()->hasUrls() ) {
+        event->acceptProposedAction();
+    }
+}
+
+void DualFileView::dropEvent( QDropEvent* event )
+{
+    QList<QUrl> urls = event->mimeData()->urls();
+    if( urls.count() > 0 ) {
+        emit fileDropped( urls.at( 0 ).toLocalFile(), paneAt( event->pos().y() ) );
+    }
+    // In view instance, we can ignore the event data because we
+    // have passed it to controller via signal
+    event->setDropAction( Qt::IgnoreAction );
+    event->accept();
+}
+
+void DualFileView::resizeEvent( QResizeEvent* )
+{
+    if( _vscrollBarWidth != verticalScrollBar()->width() ) {
+        _vscrollBarWidth  = verticalScrollBar()->width();
+        updateGeometry();
+    }
+
+    updateLayout();
+
+    emit viewContentChanged();
+}
+
+void DualFileView::paintEvent( QPaintEvent* event )
+{
+    QPainter painter( viewport() );
+
+    int xOffset = horizontalScrollBar()->value();
+    int addressAreaWidth = _layout.addressAreaWidth();
+    int hexAreaWidth = _layout.hexAreaWidth();
+    int paneHeight = this->paneHeight();
+
+    painter.fillRect( QRect( -xOffset, event->rect().top(), addressAreaWidth, height() ), viewport()->palette().color( QPalette::Button ) );
+
+    painter.setPen( viewport()->palette().color( QPalette::WindowText ) );
+    painter.drawLine( addressAreaWidth + hexAreaWidth - xOffset, event->rect().top(), addressAreaWidth + hexAreaWidth -xOffset, event->rect().bottom() );
+    painter.drawLine( 0, paneHeight, viewport()->width(), paneHeight );
+
+    for( int pane( 0 ); pane < DualFileView::panes; pane++ ) {
+        if( !_data[pane] )
+            drawEmptyViewInstructions( painter, pane );
+    }
+
+    if( !_lineCount )
+        return;
+
+    _addend = addressAddend();
+    updateFrameDiff();
+
+    const qint64 bytesPerLine = _layout.bytesPerLine();
+    const int bytesPerGroup = _layout.bytesPerGroup();
+    const int cellBytes = _layout.cellBytes();
+    const int cellWidth = _layout.cellWidth();
+    const int charWidth = _layout.charWidth();
+    const QColor buttonText = viewport()->palette().color( QPalette::ButtonText );
+    QChar text[ViewLayout::maxTextChars];
+    int textLength( 0 );
+
+    int yIncr = _layout.lineHeight();
+    for( qint64 row( 0 ); row < qMin( static_cast<qint64>( _linesOnPane ), _lineCount ); row++ ) {
+        qint64 addr = row * bytesPerLine + _addend;
+        const uchar* frameDiff = _frameDiff.constData() + row * bytesPerLine;
+        qint64 lineBytes[DualFileView::panes];
+        int yPos[DualFileView::panes];
+        for( int pane( 0 ); pane < DualFileView::panes; pane++ ) {
+            lineBytes[pane] = _data[pane] ? qMin( bytesPerLine, _size[pane] - addr ) : 0;
+            yPos[pane] = pane * paneHeight + static_cast<int>( row + 1 ) * yIncr;
+        }
+
+        // Address text is same on both panes
+        painter.setPen( buttonText );
+        _text.setUnicode( text, _layout.formatAddress( text, addr ) );
+        for( int pane( 0 ); pane < DualFileView::panes; pane++ ) {
+            if( lineBytes[pane] > 0 )
+                painter.drawText( _layout.leftMargin() - xOffset, yPos[pane], _text );
+        }
+
+        // Pen is switched only when color changes
+        Qt::GlobalColor pen = Qt::black;
+        painter.setPen( pen );
+
+        int xPos = addressAreaWidth + _layout.leftMargin() - xOffset;
+        for( qint64 b( 0 ); b < qMax( lineBytes[0], lineBytes[1] ); b += cellBytes, xPos += cellWidth ) {
+            if( b > 0 && b % bytesPerGroup == 0 )
+                xPos += _layout.groupGap();
+
+            // Cell is drawn as differing if any of its bytes do
+            bool differs = false;
+            bool compared = true;
+            for( qint64 c( b ); c < qMin( b + cellBytes, bytesPerLine ); c++ ) {
+                differs |= frameDiff[c] == DualFileView::Differs;
+                compared &= frameDiff[c] == DualFileView::Equal;
+            }
+            Qt::GlobalColor color = differs ? Qt::red : Qt::black;
+            if( color != pen ) {
+                pen = color;
+                painter.setPen( pen );
+            }
+
+            // Cells compared equal are formatted once and drawn on both panes,
+            // hash tree alone doesn't prove the mapped bytes are still alike
+            for( int pane( 0 ); pane < DualFileView::panes; pane++ ) {
+                if( b >= lineBytes[pane] )
+                    continue;
+                if( pane == 0 || !compared || lineBytes[0] <= b ) {
+                    int bytes = static_cast<int>( qMin( static_cast<qint64>( cellBytes ), lineBytes[pane] - b ) );
+                    textLength = _layout.formatCell( text, _data[pane] + b + addr, bytes );
+                }
+                _text.setUnicode( text, textLength );
+                painter.drawText( xPos, yPos[pane], _text );
+            }
+        }
+
+        xPos = addressAreaWidth + hexAreaWidth + _layout.leftMargin() - xOffset;
+        for( qint64 c( 0 ); c < qMax( lineBytes[0], lineBytes[1] ); c++, xPos += charWidth ) {
+            Qt::GlobalColor color = frameDiff[c] == DualFileView::Differs ? Qt::red : Qt::black;
+            if( color != pen ) {
+                pen = color;
+                painter.setPen( pen );
+            }
+            for( int pane( 0 ); pane < DualFileView::panes; pane++ ) {
+                if( c >= lineBytes[pane] )
+                    continue;
+                uchar binByte = *( _data[pane] + c + addr );
+                text[0] = isprint( binByte ) ? QLatin1Char( static_cast<char>( binByte ) ) : QLatin1Char( '.' );
+                _text.setUnicode( text, 1 );
+                painter.drawText( xPos, yPos[pane], _text );
+            }
+        }
+    }
+    painter.setPen( viewport()->palette().color( QPalette::WindowText ) );
+}
+
+void DualFileView::scrollContentsBy( int, int )
+{
+    // Top line follows the scroll bar only when it was moved to another step,
+    // so a line set within a step of several lines is kept
+    const int step = verticalScrollBar()->value();
+    if( step != _topLine / _linesPerStep ) {
+        _topLine = qMin( static_cast<qint64>( step ) * _linesPerStep, maxTopLine() );
+        _addend = addressAddend();
+    }
+
+    emit viewContentChanged();
+    viewport()->update();
+}
+
+bool DualFileView::viewportEvent( QEvent* event )
+{
+    // Tool tip tells which file is on the pane under cursor
+    if( event->type() == QEvent::ToolTip ) {
+        QHelpEvent* helpEvent = static_cast<QHelpEvent*>( event );
+        const QString& fileName = _fileName[paneAt( helpEvent->pos().y() )];
+        if( fileName.isEmpty() )
+            QToolTip::hideText();
+        else
+            QToolTip::showText( helpEvent->globalPos(), fileName, viewport() );
+        return true;
+    }
+
+    return QAbstractScrollArea::viewportEvent( event );
+}
+
+void DualFileView::updateLayout()
+{
+    _layout.setFont( font() );
+    _layout.fitToWidth( viewport()->width() );
+
+    _linesOnPane = qMax( 1, ( paneHeight() - _layout.bottomMargin() ) / _layout.lineHeight() );
+
+    qint64 size = qMax( _size[0], _size[1] );
+    _lineCount = size / _layout.bytesPerLine();
+    if( size % _layout.bytesPerLine() )
+        _lineCount += 1;
+
+    horizontalScrollBar()->setRange( 0, _layout.preFitWidth( _layout.byteGroups() ) - viewport()->width() );
+    horizontalScrollBar()->setPageStep( viewport()->width() );
+
+    // Keep address on top line in view, even if bytes per line changed
+    const qint64 topLine = _addend / _layout.bytesPerLine();
+
+    // Scroll bar range is int, so lines of a huge file
+    // (e.g. 8 bytes per line over 16GB) are scrolled several at a time
+    qint64 scrollLines = qMax( static_cast<qint64>( 0 ), _lineCount - _linesOnPane );
+    _linesPerStep = static_cast<int>( scrollLines / INT_MAX + 1 );
+    verticalScrollBar()->setRange( 0, static_cast<int>( ( scrollLines + _linesPerStep - 1 ) / _linesPerStep ) );
+    verticalScrollBar()->setPageStep( qMax( 1, _linesOnPane / _linesPerStep ) );
+    setTopLine( topLine );
+}
+
+void DualFileView::setTopLine( const qint64 line )
+{
+    _topLine = qBound( static_cast<qint64>( 0 ), line, maxTopLine() );
+    _addend = addressAddend();
+
+    // Scroll bar moves only if the line is on another step of it
+    const int step = static_cast<int>( _topLine / _linesPerStep );
+    if( verticalScrollBar()->value() != step ) {
+        verticalScrollBar()->setValue( step );
+        return;
+    }
+
+    emit viewContentChanged();
+    viewport()->update();
+}
+
+void DualFileView::updateFrameDiff()
+{
+    const qint64 frameBytes = static_cast<qint64>( _linesOnPane ) * _layout.bytesPerLine();
+    _frameDiff.resize( static_cast<int>( frameBytes ) );
+    uchar* diff = _frameDiff.data();
+
+    // Nothing to compare against until both panes have a file
+    if( !_data[0] || !_data[1] ) {
+        std::memset( diff, DualFileView::Unchecked, static_cast<size_t>( frameBytes ) );
+        return;
+    }
+
+    const qint64 minSize = qMin( _size[0], _size[1] );
+    const qint64 maxSize = qMax( _size[0], _size[1] );
+
+    for( qint64 c( 0 ); c < frameBytes; c++ ) {
+        qint64 addr = _addend + c;
+        qint64 block = addr / _diffBlockSize;
+        if( block < _differingBlocks.size() && !_differingBlocks.testBit( static_cast<int>( block ) ) ) {
+            // Hash tree says block is equal, no need to compare its bytes
+            qint64 blockEnd = qMin( ( block + 1 ) * _diffBlockSize - _addend, frameBytes );
+            std::memset( diff + c, DualFileView::Unchecked, static_cast<size_t>( blockEnd - c ) );
+            c = blockEnd - 1;
+        }
+        else if( addr < minSize ) {
+            diff[c] = *( _data[0] + addr ) != *( _data[1] + addr ) ? DualFileView::Differs : DualFileView::Equal;
+        }
+        else {
+            // Address offset beyond smaller file size
+            diff[c] = addr < maxSize ? DualFileView::Differs : DualFileView::Unchecked;
+        }
+    }
+}
+
+void DualFileView::addLayoutMenu( const QString& title, QActionGroup* group, const QList<QPair<QString, int>>& items )
+{
+    QMenu* menu = _contextMenu->addMenu( title );
+    for( const auto& item : items ) {
+        QAction* action = menu->addAction( item.first );
+        action->setCheckable( true );
+        action->setData( item.second );
+        group->addAction( action );
+    }
+    connect( group, &QActionGroup::triggered, this, &DualFileView::layoutActionTriggered );
+}
+
+void DualFileView::layoutActionTriggered( QAction* action )
+{
+    int value = action->data().toInt();
+
+    if( action->actionGroup() == _bytesPerLineActions )
+        setBytesPerLine( value );
+    else if( action->actionGroup() == _bytesPerGroupActions )
+        setBytesPerGroup( value );
+    else if( action->actionGroup() == _displayUnitActions )
+        setDisplayUnit( static_cast<ViewLayout::DisplayUnit>( value ) );
+    else
+        setEndianness( static_cast<ViewLayout::Endianness>( value ) );
+
+    emit viewContentChanged();
+}
+
+void DualFileView::updateLayoutMenu()
+{
+    // Bytes per line shows the value in effect, lengths which are not
+    // whole groups can't be chosen
+    const QList<QPair<QActionGroup*, int>> checked = {
+        { _bytesPerLineActions, _layout.bytesPerLineSetting() ? _layout.bytesPerLine() : 0 },
+        { _bytesPerGroupActions, _layout.bytesPerGroupSetting() },
+        { _displayUnitActions, _layout.displayUnit() },
+        { _endiannessActions, _layout.endianness() }
+    };
+
+    for( const auto& c : checked ) {
+        for( auto action : c.first->actions() )
+            action->setChecked( action->data().toInt() == c.second );
+    }
+
+    for( auto action : _bytesPerLineActions->actions() )
+        action->setEnabled( action->data().toInt() % _layout.bytesPerGroup() == 0 );
+}
+
+void DualFileView::drawEmptyViewInstructions( QPainter& painter, const int pane )
+{
+    QString help1( tr( "< Drag & drop or >" ) );
+    QString help2( tr( "< use ctx menu >" ) );
+    QString help3( tr( "< to open a file >" ) ) ;
+
+    int addressAreaWidth = _layout.addressAreaWidth();
+    int hexAreaWidth = _layout.hexAreaWidth();
+    int xPos = addressAreaWidth + hexAreaWidth / 2 - fontMetrics().width( help1 ) / 2;
+    int yIncr = fontMetrics().height();
+    int yPos = pane * paneHeight() + ( paneHeight() + yIncr / 2 - 3 * yIncr + yIncr ) / 2;
+    painter.drawText( xPos, yPos, help1 );
+    yPos += yIncr;
+    int xPos2 = addressAreaWidth + hexAreaWidth / 2 - fontMetrics().width( help2 ) / 2;
+    painter.drawText( xPos2, yPos, help2 );
+    yPos += yIncr;
+    painter.drawText( xPos, yPos, help3 );
+}
@@ -0,0 +1,137 @@
+//*****************************************************************************
+//
+//     dualfileview.h
+//     Copyright(c) 2016 Juha T Nikkanen <nikkej@gmail.com>
+//
+// --- Legal stuff ---
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//*****************************************************************************
+
+#ifndef DUALFILEVIEW_H
+#define DUALFILEVIEW_H
+
+#include <QAbstractScrollArea>
+#include <QBitArray>
+#include <QVector>
+
+#include "viewlayout.h"
+
+class QMenu;
+class QAction;
+class QActionGroup;
+
+// Two files drawn on upper and lower pane of one viewport. Panes share
+// layout and scroll bars, diff of the visible data is computed once per
+// paint and both panes are drawn in the same pass from it.
+class DualFileView : public QAbstractScrollArea
+{
+    Q_OBJECT
+
+public:
+    enum Constants {
+        panes = 2,
+        minimumOfLines = 16            // per pane
+    };
+
+    // Frame diff of one byte in view
+    enum FrameDiff {
+        Equal,                         // bytes compared equal
+        Differs,
+        Unchecked                      // equal by hash tree or nothing to compare to
+    };
+
+    DualFileView( QWidget* parent = nullptr );
+    virtual ~DualFileView();
+
+    virtual QSize viewportSizeHint() const;
+    virtual void setFont( QFont );
+    void setData( const int, const uchar*, const qint64 );
+    void setFileName( const int, const QString& );
+    void setDifferingBlocks( const QBitArray&, const int );
+    inline int capacity() { return _linesOnPane * _layout.bytesPerLine(); }
+    inline int bytesPerLine() { return _layout.bytesPerLine(); }
+    qint64 addressAddend();
+    void scrollToAddress( const qint64 );
+    QRect paneRect( const int ) const; // in view's coordinates, for widgets beside it
+    inline const QVector<uchar>& frameDiff() const { return _frameDiff; }  // of last painted frame
+
+    // Layout settings, bytes per line of 0 fits line to view's width
+    inline const ViewLayout& layout() const { return _layout; }
+    void setBytesPerLine( const int );
+    void setBytesPerGroup( const int );
+    void setDisplayUnit( const ViewLayout::DisplayUnit );
+    void setEndianness( const ViewLayout::Endianness );
+
+signals:
+    void fileDropped( QString, int );
+    void fileOpenRequested( int );
+    void viewContentChanged();
+
+public slots:
+    void showContextMenu( const QPoint& );
+
+protected:
+    virtual void dragEnterEvent( QDragEnterEvent* );
+    virtual void dropEvent( QDropEvent* );
+    virtual void resizeEvent( QResizeEvent* );
+    virtual void paintEvent( QPaintEvent* );
+    virtual void scrollContentsBy( int, int );
+    virtual bool viewportEvent( QEvent* );
+
+private: // Methods
+    inline int paneHeight() const { return viewport()->height() / DualFileView::panes; }
+    inline int paneAt( const int y ) const { return y < paneHeight() ? 0 : 1; }
+    inline qint64 maxTopLine() const { return qMax( static_cast<qint64>( 0 ), _lineCount - _linesOnPane ); }
+    void setTopLine( const qint64 );
+    void updateLayout();
+    void updateFrameDiff();
+    void addLayoutMenu( const QString&, QActionGroup*, const QList<QPair<QString, int>>& );
+    void layoutActionTriggered( QAction* );
+    void updateLayoutMenu();
+    void drawEmptyViewInstructions( QPainter&, const int );
+
+private: // No copying
+    DualFileView( const DualFileView& );
+    DualFileView& operator=( const DualFileView& );
+
+private: // Data
+    QMenu*        _contextMenu;
+    QAction*      _contextAction;
+    QActionGroup* _bytesPerLineActions;
+    QActionGroup* _bytesPerGroupActions;
+    QActionGroup* _displayUnitActions;
+    QActionGroup* _endiannessActions;
+    ViewLayout    _layout;
+    QString       _text;               // scratch for drawn texts, keeps its capacity
+    QString       _fileName[DualFileView::panes];  // shown as pane's tool tip
+    const uchar*  _data[DualFileView::panes];   // ptrs to raw binary data, not owned
+    qint64        _size[DualFileView::panes];   // accessible file sizes
+    QBitArray     _differingBlocks;    // from block hash compare, empty if not in use
+    int           _diffBlockSize;
+    QVector<uchar> _frameDiff;         // FrameDiff per byte in view
+    qint64        _addend;             // address of top line
+    qint64        _topLine;            // exact, scroll bar has only every _linesPerStep'th line
+    qint64        _lineCount;          // == division of larger size per # of bytes on one line
+    int           _linesOnPane;        // # of lines one pane is capable to draw
+    int           _linesPerStep;       // lines per scroll bar step, > 1 only if line count overflows int
+    int           _contextPane;        // pane context menu was opened on
+
+    // To fine tune widget viewport minimum size
+    int     _vscrollBarWidth;
+};
+
+#endif // DUALFILEVIEW_H
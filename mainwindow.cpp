@@ -21,100 +21,95 @@
 //
 //*****************************************************************************
 
+
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
+#include "dualfileview.h"
+#include "statisticspanel.h"
 
+#include <QActionGroup>
+#include <QApplication>
 #include <QDebug>
 #include <QFileDialog>
 #include <QScrollBar>
-#include <sys/mman.h>
+#include <QtConcurrent>
 
 MainWindow::MainWindow( QWidget *parent ) :
     QMainWindow( parent ),
     ui( new Ui::MainWindow ),
-    _diffMap( nullptr ),
-    _diffMapSize( 0 )
+    _files(),
+    _retiredFiles(),
+    _differingBlocks(),
+    _lastDifference( -1 ),
+    _hashTreeWatcher(),
+    _blockDiffPending( false ),
+    _statisticsWatcher(),
+    _statisticsPending( false ),
+    _openCount( 0 )
 {
     ui->setupUi( this );
 
     setWindowTitle( QCoreApplication::applicationName() );
 
-//    ui->binFileView1->setAcceptDrops( true );
-//    ui->binFileView2->setAcceptDrops( true );
-
-    ui->binFileView1->setFont( QFont( "Monospace", 10 ) );
-    ui->binFileView2->setFont( QFont( "Monospace", 10 ) );
-
-    // Cross-connect vertical & horizontal scroll bars
-    connect( ui->binFileView1->verticalScrollBar(), \
-             SIGNAL( valueChanged( int ) ), \
-             ui->binFileView2->verticalScrollBar(), \
-             SLOT( setValue( int ) ) );
-    connect( ui->binFileView2->verticalScrollBar(), \
-             SIGNAL( valueChanged( int ) ), \
-             ui->binFileView1->verticalScrollBar(), \
-             SLOT( setValue( int ) ) );
-
-    connect( ui->binFileView1->horizontalScrollBar(), \
-             SIGNAL( valueChanged( int ) ), \
-             ui->binFileView2->horizontalScrollBar(), \
-             SLOT( setValue( int ) ) );
-    connect( ui->binFileView2->horizontalScrollBar(), \
-             SIGNAL( valueChanged( int ) ), \
-             ui->binFileView1->horizontalScrollBar(), \
-             SLOT( setValue( int ) ) );
-
-    // to maintain consistent width for both views
-    connect( ui->binFileView1, SIGNAL( defaultVisualsChanged( BinFileView* ) ), \
-             ui->binFileView2, SLOT( synchronizeVisuals( BinFileView* ) ) );
-    connect( ui->binFileView2, SIGNAL( defaultVisualsChanged( BinFileView* ) ), \
-             ui->binFileView1, SLOT( synchronizeVisuals( BinFileView* ) ) );
+    ui->dualFileView->setFont( QFont( "Monospace", 10 ) );
 
     // File drag & drop signals
-    connect( ui->binFileView1, SIGNAL( fileDropped( QString, BinFileView* ) ), \
-             this, SLOT( open( QString, BinFileView* ) ) );
-    connect( ui->binFileView2, SIGNAL( fileDropped( QString, BinFileView* ) ), \
-             this, SLOT( open( QString, BinFileView* ) ) );
+    connect( ui->dualFileView, SIGNAL( fileDropped( QString, int ) ), \
+             this, SLOT( open( QString, int ) ) );
 
     // And view's file ctx menu signals
-    connect( ui->binFileView1, SIGNAL( fileOpenRequested( BinFileView* ) ), \
-             this, SLOT( open( BinFileView* ) ) );
-    connect( ui->binFileView2, SIGNAL( fileOpenRequested( BinFileView* ) ), \
-             this, SLOT( open( BinFileView* ) ) );
+    connect( ui->dualFileView, SIGNAL( fileOpenRequested( int ) ), \
+             this, SLOT( open( int ) ) );
+
+    // Hash trees and statistics are built on worker threads
+    connect( &_hashTreeWatcher, SIGNAL( finished() ), \
+             this, SLOT( blockDiffFinished() ) );
+    connect( &_statisticsWatcher, SIGNAL( finished() ), \
+             this, SLOT( statisticsFinished() ) );
 
-    // On demand (i.e. via changed content of view's data) requested diffing
-    connect( ui->binFileView1, SIGNAL( fileViewContentChanged( BinFileView* ) ), \
-             this, SLOT( updateDiff( BinFileView* ) ), Qt::DirectConnection );
-    connect( ui->binFileView2, SIGNAL( fileViewContentChanged( BinFileView* ) ), \
-             this, SLOT( updateDiff( BinFileView* ) ), Qt::DirectConnection );
+    // Statistics strips are shown beside panes on request, they also
+    // follow the view and move it when clicked
+    ui->statisticsPanel->hide();
+    connect( ui->dualFileView, SIGNAL( viewContentChanged() ), \
+             this, SLOT( updateVisibleRange() ) );
+    connect( ui->dualFileView, SIGNAL( viewContentChanged() ), \
+             this, SLOT( alignStrips() ) );
+    connect( ui->statisticsPanel, SIGNAL( addressRequested( qint64 ) ), \
+             this, SLOT( scrollToAddress( qint64 ) ) );
+
+    QActionGroup* stripModes = new QActionGroup( this );
+    stripModes->addAction( ui->actionEntropy );
+    stripModes->addAction( ui->actionZero_fill );
+    stripModes->addAction( ui->actionStatistics_delta );
+    ui->actionEntropy->setData( StatisticsStrip::Entropy );
+    ui->actionZero_fill->setData( StatisticsStrip::ZeroFill );
+    ui->actionStatistics_delta->setData( StatisticsStrip::Delta );
+    connect( stripModes, &QActionGroup::triggered, [=]( QAction* action ) {
+        ui->statisticsPanel->setMode( static_cast<StatisticsStrip::Mode>( action->data().toInt() ) );
+    } );
 
     // Get the arguments
     if( QCoreApplication::arguments().size() == 3 ) {
-        open( QCoreApplication::arguments().at( 1 ), ui->binFileView1 );
-        open( QCoreApplication::arguments().at( 2 ), ui->binFileView2 );
+        open( QCoreApplication::arguments().at( 1 ), 0 );
+        open( QCoreApplication::arguments().at( 2 ), 1 );
     }
 }
 
 MainWindow::~MainWindow()
 {
+    waitForJobs();
     delete ui;
-    if( !_files.empty() ) {
-        for( const auto f : _files ) {
-            f._file->unmap( f._mmap );
-            f._file->close();
-            delete f._file;
-        }
-    }
-    if( _diffMap )
-        ::munmap( _diffMap, static_cast<size_t>( _diffMapSize ) );
+    releaseRetiredFiles();
+    for( const auto& f : _files )
+        closeFile( f );
 }
 
-void MainWindow::open( BinFileView* view )
+void MainWindow::open( int pane )
 {
-    open( QFileDialog::getOpenFileName( this ), view );
+    open( QFileDialog::getOpenFileName( this ), pane );
 }
 
-void MainWindow::open( const QString& fileName , BinFileView* view )
+void MainWindow::open( const QString& fileName , int pane )
 {
     if ( !fileName.isEmpty() ) {
         QFile *file = new QFile( fileName );
@@ -133,83 +128,327 @@ void MainWindow::open( const QString& fileName , BinFileView* view )
             return;
         }
 
-        if( view ) {
-            const auto f = _files.find( view );
-            if( f != _files.end() ) {
-                (*f)._file->unmap( (*f)._mmap );
-                (*f)._file->close();
-                delete (*f)._file;
-            }
-            _files.insert( view, FileModel( file, mmap ) );
-            view->setData( mmap, file->size() );
-            view->setToolTip( fileName );
+        // Replaced file is closed once no job reads its mapping any more
+        const auto f = _files.find( pane );
+        if( f != _files.end() ) {
+            _retiredFiles.append( *f );
+            releaseRetiredFiles();
         }
-        if( _files.size() == 2 ) {
-            if( _diffMap )
-                ::munmap( _diffMap, static_cast<size_t>( _diffMapSize ) );
+        _files.insert( pane, FileModel( file, mmap, _openCount++ ) );
+        ui->dualFileView->setData( pane, mmap, file->size() );
+        ui->dualFileView->setFileName( pane, fileName );
+        updateStatistics();
+        updateBlockDiff();
+        updateVisibleRange();
+    }
+}
 
-            auto f = _files.begin();
-            qint64 size1 = (*f)._file->size();
-            qint64 size2 = (*++f)._file->size();
-            _diffMapSize = qMax( size1, size2 );
+void MainWindow::on_actionE_xit_triggered()
+{
+    this->close();
+}
 
-            // Qt's QFileDevice::map doesn't eat original mmap flags, --> use 'real stuff' here!
-            _diffMap = static_cast<uchar*>( ::mmap( nullptr, static_cast<size_t>( _diffMapSize ), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 ) );
+void MainWindow::on_actionBlock_hash_compare_toggled( bool )
+{
+    updateBlockDiff();
+}
 
-            if( !_diffMap ) {
-                qWarning() << "Mapping failed!!!!";
-            }
-            else {
-                updateDiff( nullptr );
-                QList<BinFileView*> views = _files.keys();
-                for( auto v : views )
-                    v->setColoringData( _diffMap );
+void MainWindow::on_actionNext_difference_triggered()
+{
+    // Continue from the difference found last while it is in view, it isn't
+    // on top line near the end of file. Otherwise search from the line after
+    // the topmost one, to not get stuck on it.
+    qint64 from = ui->dualFileView->addressAddend() + ui->dualFileView->bytesPerLine();
+    if( isInView( _lastDifference ) )
+        from = _lastDifference + 1;
+
+    qint64 addr = findDifference( from, true );
+    if( addr >= 0 ) {
+        _lastDifference = addr;
+        scrollToAddress( addr );
+    }
+}
+
+void MainWindow::on_actionPrevious_difference_triggered()
+{
+    qint64 from = ui->dualFileView->addressAddend();
+    if( isInView( _lastDifference ) )
+        from = _lastDifference;
+
+    qint64 addr = findDifference( from, false );
+    if( addr >= 0 ) {
+        _lastDifference = addr;
+        scrollToAddress( addr );
+    }
+}
+
+void MainWindow::on_actionStatistics_strips_toggled( bool )
+{
+    updateStatistics();
+}
+
+void MainWindow::updateVisibleRange()
+{
+    qint64 addend = ui->dualFileView->addressAddend();
+    ui->statisticsPanel->setVisibleRange( addend, addend + ui->dualFileView->capacity() );
+}
+
+void MainWindow::alignStrips()
+{
+    // View and panel share the grid row, so view's coordinates apply as such
+    QRect upper = ui->dualFileView->paneRect( 0 );
+    ui->statisticsPanel->setPaneGeometry( upper.top(), upper.height() );
+}
+
+void MainWindow::scrollToAddress( const qint64 addr )
+{
+    ui->dualFileView->scrollToAddress( addr );
+}
+
+void MainWindow::updateBlockDiff()
+{
+    _differingBlocks.clear();
+    _lastDifference = -1;
+    ui->dualFileView->setDifferingBlocks( _differingBlocks, BlockHashTree::defaultBlockSize );
+    ui->statisticsPanel->setDifferingBlocks( _differingBlocks, BlockHashTree::defaultBlockSize );
+    ui->actionNext_difference->setEnabled( false );
+    ui->actionPrevious_difference->setEnabled( false );
+
+    // One build at a time, a request meanwhile is served once it has finished
+    if( _hashTreeWatcher.isRunning() ) {
+        _blockDiffPending = true;
+        return;
+    }
+
+    // Trees of a build finished but not yet reported are kept, not rebuilt
+    collectHashTrees();
+
+    if( _files.size() == 2 && ui->actionBlock_hash_compare->isChecked() ) {
+        // Trees are kept with the file, so only newly opened files get hashed
+        _blockDiffPending = false;
+        const FileJobs jobs = fileJobs();
+        _hashTreeWatcher.setFuture( QtConcurrent::run( [jobs]() {
+            FileJobs built( jobs );
+            for( auto& job : built ) {
+                if( job._hashTree.isEmpty() )
+                    job._hashTree.build( job._data, job._size );
             }
-        }
+            return built;
+        } ) );
+    }
+}
+
+void MainWindow::blockDiffFinished()
+{
+    // Late signal of a build already collected, the running one reports itself
+    if( _hashTreeWatcher.isRunning() )
+        return;
+
+    collectHashTrees();
+    releaseRetiredFiles();
+
+    if( _blockDiffPending ) {
+        _blockDiffPending = false;
+        updateBlockDiff();
+        return;
+    }
+
+    if( _files.size() == 2 && ui->actionBlock_hash_compare->isChecked() ) {
+        const BlockHashTree& tree1 = _files.first()._hashTree;
+        _differingBlocks = tree1.differingBlocks( _files.last()._hashTree );
+    }
+
+    ui->dualFileView->setDifferingBlocks( _differingBlocks, BlockHashTree::defaultBlockSize );
+    ui->statisticsPanel->setDifferingBlocks( _differingBlocks, BlockHashTree::defaultBlockSize );
+    ui->actionNext_difference->setEnabled( !_differingBlocks.isEmpty() );
+    ui->actionPrevious_difference->setEnabled( !_differingBlocks.isEmpty() );
+}
+
+FileJobs MainWindow::fileJobs() const
+{
+    FileJobs jobs;
+    for( auto f = _files.constBegin(); f != _files.constEnd(); ++f )
+        jobs.insert( f.key(), { (*f)._serial, (*f)._mmap, (*f)._file->size(), (*f)._hashTree, (*f)._statistics } );
+    return jobs;
+}
+
+void MainWindow::collectHashTrees()
+{
+    if( !_hashTreeWatcher.isFinished() || _hashTreeWatcher.isCanceled() )
+        return;
+
+    // Trees of files replaced during the build are dropped
+    const FileJobs jobs = _hashTreeWatcher.result();
+    for( auto f = _files.begin(); f != _files.end(); ++f ) {
+        const auto job = jobs.find( f.key() );
+        if( job != jobs.end() && (*job)._serial == (*f)._serial )
+            (*f)._hashTree = (*job)._hashTree;
     }
 }
 
-void MainWindow::updateDiff( BinFileView* )
+void MainWindow::collectStatistics()
 {
-    if( _files.size() != 2 || !_diffMap )
+    if( !_statisticsWatcher.isFinished() || _statisticsWatcher.isCanceled() )
         return;
 
-    qint64 addend1 = ui->binFileView1->addressAddend();
-    qint64 addend2 = ui->binFileView2->addressAddend();
-    int viewCapacity = ui->binFileView1->capacity();
+    const FileJobs jobs = _statisticsWatcher.result();
+    for( auto f = _files.begin(); f != _files.end(); ++f ) {
+        const auto job = jobs.find( f.key() );
+        if( job != jobs.end() && (*job)._serial == (*f)._serial )
+            (*f)._statistics = (*job)._statistics;
+    }
+}
+
+void MainWindow::waitForJobs()
+{
+    _hashTreeWatcher.waitForFinished();
+    _statisticsWatcher.waitForFinished();
+}
+
+void MainWindow::releaseRetiredFiles()
+{
+    if( _hashTreeWatcher.isRunning() || _statisticsWatcher.isRunning() )
+        return;
+
+    for( const auto& f : _retiredFiles )
+        closeFile( f );
+    _retiredFiles.clear();
+}
+
+void MainWindow::closeFile( const FileModel& f )
+{
+    f._file->unmap( f._mmap );
+    f._file->close();
+    delete f._file;
+}
+
+void MainWindow::updateStatistics()
+{
+    bool shown = ui->actionStatistics_strips->isChecked();
+
+    ui->statisticsPanel->setVisible( shown );
+    if( !shown )
+        return;
+
+    // Strips show what is ready, files still being analyzed are left blank
+    updateStrips();
+
+    if( _statisticsWatcher.isRunning() ) {
+        _statisticsPending = true;
+        return;
+    }
+
+    // Like hash trees, statistics are kept with the file and computed once
+    collectStatistics();
+    bool missing( false );
+    for( const auto& f : _files )
+        missing |= f._statistics.isEmpty();
+    if( !missing )
+        return;
+
+    _statisticsPending = false;
+    const FileJobs jobs = fileJobs();
+    _statisticsWatcher.setFuture( QtConcurrent::run( [jobs]() {
+        FileJobs built( jobs );
+        for( auto& job : built ) {
+            if( job._statistics.isEmpty() )
+                job._statistics.build( job._data, job._size );
+        }
+        return built;
+    } ) );
+}
+
+void MainWindow::statisticsFinished()
+{
+    // See blockDiffFinished()
+    if( _statisticsWatcher.isRunning() )
+        return;
+
+    collectStatistics();
+    releaseRetiredFiles();
+
+    if( _statisticsPending ) {
+        _statisticsPending = false;
+        updateStatistics();
+        return;
+    }
+
+    updateStrips();
+}
+
+void MainWindow::updateStrips()
+{
+    for( int pane( 0 ); pane < DualFileView::panes; pane++ ) {
+        ui->statisticsPanel->strip( pane )->setStatistics( _files.value( pane, FileModel( nullptr, nullptr, -1 ) )._statistics,
+                                                         _files.value( 1 - pane, FileModel( nullptr, nullptr, -1 ) )._statistics );
+    }
+}
+
+qint64 MainWindow::findDifference( const qint64 from, const bool forward )
+{
+    if( _files.size() != 2 || _differingBlocks.isEmpty() )
+        return -1;
 
     auto f = _files.begin();
     qint64 size1 = (*f)._file->size();
     uchar* file1 = (*f)._mmap;
+    int blockSize = (*f)._hashTree.blockSize();
     qint64 size2 = (*++f)._file->size();
     uchar* file2 = (*f)._mmap;
+    qint64 minSize = qMin( size1, size2 );
+    qint64 maxSize = qMax( size1, size2 );
+
+    // Only blocks flagged by hash tree need to be compared byte by byte
+    auto differs = [&]( const qint64 c ) {
+        const qint64 b = c / blockSize;
+        if( b < _differingBlocks.size() && !_differingBlocks.testBit( static_cast<int>( b ) ) )
+            return false;
+        return c >= minSize || *( file1 + c ) != *( file2 + c );
+    };
+
+    // Differences are returned as runs of differing bytes, by their first byte
+    if( forward ) {
+        // Skip the rest of a run started before from, it has been found already
+        qint64 start( qMin( from, maxSize ) );
+        if( start > 0 && differs( start - 1 ) ) {
+            for( ; start < maxSize && differs( start ); start++ ) {
+                if( start >= minSize )
+                    return -1;     // run goes on over the tail of the longer file
+            }
+        }
 
-    if( _diffMap ) {
-        // Define compare window begin offset
-        qint64 cwBegin;
-        // If view's data position beyond smaller file's size
-        if( qMax( addend1, addend2 ) - qMin( addend1, addend2 ) > viewCapacity )
-            cwBegin = qMax( addend1, addend2 );
-        else
-            cwBegin = qMin( addend1, addend2 );
-
-        for( qint64 c( cwBegin ); c < qMax( addend1 + viewCapacity, addend2 + viewCapacity ); c++ ) {
-            if( c < qMin( size1, size2 ) ) {
-                // Compare data
-                if( *( file1 + c ) != *( file2 + c ) )
-                    *( _diffMap + c ) = (uchar)Qt::red;
-                else
-                    *( _diffMap + c ) = (uchar)Qt::black;
+        for( qint64 b( start / blockSize ); b < _differingBlocks.size(); b++ ) {
+            if( !_differingBlocks.testBit( static_cast<int>( b ) ) )
+                continue;
+            for( qint64 c( qMax( start, b * blockSize ) ); c < qMin( ( b + 1 ) * blockSize, maxSize ); c++ ) {
+                if( c >= minSize || *( file1 + c ) != *( file2 + c ) )
+                    return c;
             }
-            else if( c < qMax( size1, size2 ) ) {
-                // Address offset beyond smaller file size
-                *( _diffMap + c ) = (uchar)Qt::red;
+        }
+    }
+    else if( from > 0 ) {
+        const qint64 end( qMin( from, maxSize ) );
+        for( qint64 b( ( end - 1 ) / blockSize ); b >= 0; b-- ) {
+            if( b >= _differingBlocks.size() || !_differingBlocks.testBit( static_cast<int>( b ) ) )
+                continue;
+            for( qint64 c( qMin( end, ( b + 1 ) * blockSize ) - 1 ); c >= b * blockSize; c-- ) {
+                if( c >= minSize || *( file1 + c ) != *( file2 + c ) ) {
+                    // Walk back to the start of the run, tail of the longer
+                    // file differs as a whole
+                    qint64 first( qMin( c, minSize ) );
+                    while( first > 0 && differs( first - 1 ) )
+                        first--;
+                    return first;
+                }
             }
         }
     }
+
+    return -1;
 }
 
-void MainWindow::on_actionE_xit_triggered()
+bool MainWindow::isInView( const qint64 addr )
 {
-    this->close();
+    qint64 addend = ui->dualFileView->addressAddend();
+    return addr >= addend && addr < addend + ui->dualFileView->capacity();
 }
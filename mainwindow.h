@@ -26,21 +26,39 @@
 
 #include <QMainWindow>
 #include <QMap>
+#include <QBitArray>
+#include <QFutureWatcher>
+
+#include "blockhashtree.h"
+#include "bytestatistics.h"
 
 
 namespace Ui {
 class MainWindow;
 }
 class QFile;
-class BinFileView;
 
 struct FileModel
 {
-    FileModel( QFile* file, uchar* mmap ) : _file( file ), _mmap( mmap ) {}
+    FileModel( QFile* file, uchar* mmap, const int serial ) : _file( file ), _mmap( mmap ), _serial( serial ), _hashTree(), _statistics() {}
     QFile* _file;
     uchar* _mmap;
+    int _serial;               // tells files apart, a reopen may get the same mmap address
+    BlockHashTree _hashTree;   // built once per opened file, if block compare is on
+    ByteStatistics _statistics; // likewise, if statistics strips are shown
 };
 
+// Opened file as handed to a worker thread, results are matched back by serial
+struct FileJob
+{
+    int _serial;
+    const uchar* _data;
+    qint64 _size;
+    BlockHashTree _hashTree;
+    ByteStatistics _statistics;
+};
+typedef QMap<int, FileJob> FileJobs;   // by pane of dual view
+
 class MainWindow : public QMainWindow
 {
     Q_OBJECT
@@ -50,10 +68,31 @@ public:
     ~MainWindow();
 
 private slots:
-    void open( BinFileView* );
-    void open( const QString&, BinFileView* view = nullptr );
-    void updateDiff( BinFileView* );
+    void open( int );
+    void open( const QString&, int );
     void on_actionE_xit_triggered();
+    void on_actionBlock_hash_compare_toggled( bool );
+    void on_actionNext_difference_triggered();
+    void on_actionPrevious_difference_triggered();
+    void on_actionStatistics_strips_toggled( bool );
+    void updateVisibleRange();
+    void scrollToAddress( const qint64 );
+    void alignStrips();
+    void blockDiffFinished();
+    void statisticsFinished();
+
+private: // Methods
+    void updateBlockDiff();
+    FileJobs fileJobs() const;
+    void collectHashTrees();
+    void collectStatistics();
+    void waitForJobs();
+    void releaseRetiredFiles();
+    static void closeFile( const FileModel& );
+    void updateStatistics();
+    void updateStrips();
+    qint64 findDifference( const qint64, const bool );
+    bool isInView( const qint64 );
 
 private: // No copying
     MainWindow( const MainWindow& );
@@ -61,9 +100,15 @@ private: // No copying
 
 private: // Data
     Ui::MainWindow* ui;
-    QMap<BinFileView* , struct FileModel> _files;
-    uchar* _diffMap;
-    qint64 _diffMapSize;
+    QMap<int, struct FileModel> _files;     // by pane of dual view
+    QList<FileModel> _retiredFiles; // replaced while a job may still read them
+    QBitArray _differingBlocks;    // per hash tree block, empty when block compare is off
+    qint64 _lastDifference;        // found by Next/Previous difference, -1 if none
+    QFutureWatcher<FileJobs> _hashTreeWatcher;
+    bool _blockDiffPending;        // requested while building, rerun when finished
+    QFutureWatcher<FileJobs> _statisticsWatcher;
+    bool _statisticsPending;       // likewise
+    int _openCount;                // serial of the next opened file
 };
 
 #endif // MAINWINDOW_H
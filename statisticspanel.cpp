@@ -0,0 +1,90 @@
+//*****************************************************************************
+//
+//     statisticspanel.cpp
+//     Copyright(c) 2016 Juha T Nikkanen <nikkej@gmail.com>
+//
+// --- Legal stuff ---
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//*****************************************************************************
+
+#include "statisticspanel.h"
+
+StatisticsPanel::StatisticsPanel( QWidget* parent )
+    : QWidget( parent ),
+      _strips(),
+      _paneTop( 0 ),
+      _paneHeight( 0 )
+{
+    setSizePolicy( QSizePolicy::Fixed, QSizePolicy::MinimumExpanding );
+
+    for( int pane( 0 ); pane < StatisticsPanel::panes; pane++ ) {
+        _strips[pane] = new StatisticsStrip( this );
+        connect( _strips[pane], SIGNAL( addressRequested( qint64 ) ), \
+                 this, SIGNAL( addressRequested( qint64 ) ) );
+    }
+}
+
+StatisticsPanel::~StatisticsPanel()
+{
+}
+
+QSize StatisticsPanel::sizeHint() const
+{
+    return( QSize( StatisticsStrip::stripWidth, 0 ) );
+}
+
+void StatisticsPanel::setMode( const StatisticsStrip::Mode mode )
+{
+    for( auto strip : _strips )
+        strip->setMode( mode );
+}
+
+void StatisticsPanel::setVisibleRange( const qint64 begin, const qint64 end )
+{
+    for( auto strip : _strips )
+        strip->setVisibleRange( begin, end );
+}
+
+void StatisticsPanel::setDifferingBlocks( const QBitArray& blocks, const int blockSize )
+{
+    for( auto strip : _strips )
+        strip->setDifferingBlocks( blocks, blockSize );
+}
+
+void StatisticsPanel::setPaneGeometry( const int top, const int height )
+{
+    if( top == _paneTop && height == _paneHeight )
+        return;
+
+    _paneTop = top;
+    _paneHeight = height;
+    placeStrips();
+}
+
+void StatisticsPanel::resizeEvent( QResizeEvent* )
+{
+    placeStrips();
+}
+
+void StatisticsPanel::placeStrips()
+{
+    const int top = _paneHeight > 0 ? _paneTop : 0;
+    const int height = _paneHeight > 0 ? _paneHeight : this->height() / StatisticsPanel::panes;
+
+    for( int pane( 0 ); pane < StatisticsPanel::panes; pane++ )
+        _strips[pane]->setGeometry( 0, top + pane * height, width(), height );
+}
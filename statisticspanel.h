@@ -0,0 +1,75 @@
+//*****************************************************************************
+//
+//     statisticspanel.h
+//     Copyright(c) 2016 Juha T Nikkanen <nikkej@gmail.com>
+//
+// --- Legal stuff ---
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//*****************************************************************************
+
+#ifndef STATISTICSPANEL_H
+#define STATISTICSPANEL_H
+
+#include <QWidget>
+
+#include "statisticsstrip.h"
+
+// Statistics strips of both files stacked like the panes of dual view.
+// Strips are placed by the panes' geometry, not by a layout, so that the
+// split follows the view and not the frame or scroll bar around it.
+class StatisticsPanel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    enum Constants {
+        panes = 2
+    };
+
+    StatisticsPanel( QWidget* parent = nullptr );
+    virtual ~StatisticsPanel();
+
+    virtual QSize sizeHint() const;
+    inline StatisticsStrip* strip( const int pane ) const { return _strips[pane]; }
+    void setMode( const StatisticsStrip::Mode );
+    void setVisibleRange( const qint64, const qint64 );
+    void setDifferingBlocks( const QBitArray&, const int );
+
+    // Top of upper pane and height of one pane, in coordinates shared
+    // with the view beside
+    void setPaneGeometry( const int, const int );
+
+signals:
+    void addressRequested( qint64 );
+
+protected:
+    virtual void resizeEvent( QResizeEvent* );
+
+private: // Methods
+    void placeStrips();
+
+private: // No copying
+    StatisticsPanel( const StatisticsPanel& );
+    StatisticsPanel& operator=( const StatisticsPanel& );
+
+private: // Data
+    StatisticsStrip* _strips[StatisticsPanel::panes];
+    int           _paneTop;
+    int           _paneHeight;         // 0 until set, strips split the panel evenly
+};
+
+#endif // STATISTICSPANEL_H
@@ -0,0 +1,181 @@
+//*****************************************************************************
+//
+//     statisticsstrip.cpp
+//     Copyright(c) 2016 Juha T Nikkanen <nikkej@gmail.com>
+//
+// --- Legal stuff ---
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//*****************************************************************************
+
+#include "statisticsstrip.h"
+
+#include <QMouseEvent>
+#include <QPainter>
+#include <QPaintEvent>
+#include <cstdlib>
+
+StatisticsStrip::StatisticsStrip( QWidget* parent )
+    : QWidget( parent ),
+      _statistics(),
+      _reference(),
+      _differingBlocks(),
+      _diffBlockSize( 1 ),
+      _mode( StatisticsStrip::Entropy ),
+      _visibleBegin( 0 ),
+      _visibleEnd( 0 )
+{
+    setSizePolicy( QSizePolicy::Fixed, QSizePolicy::MinimumExpanding );
+    setToolTip( tr( "Entropy, zero fill or difference overview of the file" ) );
+}
+
+StatisticsStrip::~StatisticsStrip()
+{
+}
+
+QSize StatisticsStrip::sizeHint() const
+{
+    return( QSize( StatisticsStrip::stripWidth, 0 ) );
+}
+
+void StatisticsStrip::setStatistics( const ByteStatistics& statistics, const ByteStatistics& reference )
+{
+    _statistics = statistics;
+    _reference = reference;
+    update();
+}
+
+void StatisticsStrip::setDifferingBlocks( const QBitArray& blocks, const int blockSize )
+{
+    _differingBlocks = blocks;
+    _diffBlockSize = qMax( 1, blockSize );
+    update();
+}
+
+void StatisticsStrip::setMode( const Mode mode )
+{
+    _mode = mode;
+    update();
+}
+
+void StatisticsStrip::setVisibleRange( const qint64 begin, const qint64 end )
+{
+    _visibleBegin = begin;
+    _visibleEnd = end;
+    update();
+}
+
+void StatisticsStrip::paintEvent( QPaintEvent* event )
+{
+    QPainter painter( this );
+
+    painter.fillRect( event->rect(), palette().color( QPalette::Window ) );
+
+    const qint64 size = _statistics.size();
+    const int rows = height();
+    if( !size || !rows )
+        return;
+
+    // One value per pixel row, taken from pyramid level of matching resolution
+    const qint64 bytesPerRow = qMax( static_cast<qint64>( 1 ), size / rows );
+    for( int y( event->rect().top() ); y <= event->rect().bottom() && y < rows; y++ ) {
+        const qint64 offset = y * size / rows;
+        painter.fillRect( 0, y, width(), 1, colorAt( offset, bytesPerRow ) );
+    }
+
+    // Frame the part of file in view
+    const int top = static_cast<int>( _visibleBegin * rows / size );
+    const int bottom = static_cast<int>( qMin( _visibleEnd, size ) * rows / size );
+    painter.setPen( palette().color( QPalette::Highlight ) );
+    painter.drawRect( 0, top, width() - 1, qMax( 1, bottom - top - 1 ) );
+}
+
+void StatisticsStrip::mousePressEvent( QMouseEvent* event )
+{
+    if( event->button() == Qt::LeftButton )
+        requestAddress( event->pos().y() );
+}
+
+void StatisticsStrip::mouseMoveEvent( QMouseEvent* event )
+{
+    if( event->buttons() & Qt::LeftButton )
+        requestAddress( event->pos().y() );
+}
+
+QColor StatisticsStrip::colorAt( const qint64 offset, const qint64 bytes ) const
+{
+    const int level = _statistics.levelFor( bytes );
+    const int entropy = _statistics.entropy( level, offset );
+    const int zeroFill = _statistics.zeroFill( level, offset );
+
+    switch( _mode ) {
+    case StatisticsStrip::Entropy:
+        // Low entropy is dim blue, compressed or encrypted data bright red
+        return QColor::fromHsv( ( ByteStatistics::maxValue - entropy ) * 240 / ByteStatistics::maxValue,
+                                255, 64 + entropy * 191 / ByteStatistics::maxValue );
+    case StatisticsStrip::ZeroFill:
+        return QColor( ByteStatistics::maxValue - zeroFill, ByteStatistics::maxValue - zeroFill, ByteStatistics::maxValue - zeroFill );
+    case StatisticsStrip::Delta: {
+        // Hash tree tells which blocks differ, also where statistics
+        // don't change. Nothing to compare to before either is known.
+        int delta = _differingBlocks.isEmpty() ? -1 : blockDelta( offset, bytes );
+
+        if( !_reference.isEmpty() ) {
+            // Beyond the end of the other file counts as maximal difference
+            int statisticsDelta = ByteStatistics::maxValue;
+            if( offset < _reference.size() ) {
+                const int refLevel = _reference.levelFor( bytes );
+                statisticsDelta = qMax( std::abs( entropy - _reference.entropy( refLevel, offset ) ),
+                                        std::abs( zeroFill - _reference.zeroFill( refLevel, offset ) ) );
+            }
+            delta = qMax( delta, statisticsDelta );
+        }
+
+        if( delta < 0 )
+            break;
+        return QColor( ByteStatistics::maxValue, ByteStatistics::maxValue - delta, ByteStatistics::maxValue - delta );
+    }
+    }
+
+    return palette().color( QPalette::Window );
+}
+
+int StatisticsStrip::blockDelta( const qint64 offset, const qint64 bytes ) const
+{
+    const qint64 first = offset / _diffBlockSize;
+    const qint64 last = qMin( ( offset + qMax( bytes, static_cast<qint64>( 1 ) ) - 1 ) / _diffBlockSize,
+                              static_cast<qint64>( _differingBlocks.size() ) - 1 );
+    if( first > last )
+        return 0;
+
+    // Even one differing block stands out, more of them deepen the color
+    qint64 differing( 0 );
+    for( qint64 b( first ); b <= last; b++ )
+        differing += _differingBlocks.testBit( static_cast<int>( b ) );
+    if( !differing )
+        return 0;
+
+    const int range = ByteStatistics::maxValue / 2;
+    return ByteStatistics::maxValue - range + static_cast<int>( differing * range / ( last - first + 1 ) );
+}
+
+void StatisticsStrip::requestAddress( const int y )
+{
+    if( _statistics.isEmpty() || height() <= 0 )
+        return;
+
+    emit addressRequested( qBound( 0, y, height() - 1 ) * _statistics.size() / height() );
+}
@@ -0,0 +1,85 @@
+//*****************************************************************************
+//
+//     statisticsstrip.h
+//     Copyright(c) 2016 Juha T Nikkanen <nikkej@gmail.com>
+//
+// --- Legal stuff ---
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//*****************************************************************************
+
+#ifndef STATISTICSSTRIP_H
+#define STATISTICSSTRIP_H
+
+#include <QBitArray>
+#include <QWidget>
+
+#include "bytestatistics.h"
+
+// Colored overview of a whole file drawn beside its view, top of the strip
+// is the beginning of file. Part of file currently in view is framed.
+class StatisticsStrip : public QWidget
+{
+    Q_OBJECT
+
+public:
+    enum Mode {
+        Entropy,
+        ZeroFill,
+        Delta                          // difference to the other file, by hash tree if in use
+    };
+
+    enum Constants {
+        stripWidth = 16
+    };
+
+    StatisticsStrip( QWidget* parent = nullptr );
+    virtual ~StatisticsStrip();
+
+    virtual QSize sizeHint() const;
+    void setStatistics( const ByteStatistics&, const ByteStatistics& );
+    void setDifferingBlocks( const QBitArray&, const int );
+    void setMode( const Mode );
+    void setVisibleRange( const qint64, const qint64 );
+
+signals:
+    void addressRequested( qint64 );
+
+protected:
+    virtual void paintEvent( QPaintEvent* );
+    virtual void mousePressEvent( QMouseEvent* );
+    virtual void mouseMoveEvent( QMouseEvent* );
+
+private: // Methods
+    QColor colorAt( const qint64, const qint64 ) const;
+    int blockDelta( const qint64, const qint64 ) const;
+    void requestAddress( const int );
+
+private: // No copying
+    StatisticsStrip( const StatisticsStrip& );
+    StatisticsStrip& operator=( const StatisticsStrip& );
+
+private: // Data
+    ByteStatistics _statistics;
+    ByteStatistics _reference;         // statistics of the other file
+    QBitArray     _differingBlocks;    // from block hash compare, empty if not in use
+    int           _diffBlockSize;
+    Mode          _mode;
+    qint64        _visibleBegin;
+    qint64        _visibleEnd;
+};
+
+#endif // STATISTICSSTRIP_H
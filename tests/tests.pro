@@ -0,0 +1,18 @@
+#-------------------------------------------------
+#
+# Unit tests & sparse huge file tests, run by 'make check'
+#
+#-------------------------------------------------
+
+include( ../bindiff-qt.pri )
+
+QT       += testlib
+
+TARGET = tst_bindiff
+
+TEMPLATE = app
+
+CONFIG   += console testcase
+CONFIG   -= app_bundle
+
+SOURCES += tst_bindiff.cpp
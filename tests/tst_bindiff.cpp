@@ -0,0 +1,387 @@
+//*****************************************************************************
+//
+//     tst_bindiff.cpp
+//     Copyright(c) 2016 Juha T Nikkanen <nikkej@gmail.com>
+//
+// --- Legal stuff ---
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//*****************************************************************************
+
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QScrollBar>
+#include <QTemporaryDir>
+#include <QtTest>
+#include <random>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "blockhashtree.h"
+#include "dualfileview.h"
+#include "viewlayout.h"
+
+namespace {
+
+const qint64 KiB = 1024;
+const qint64 MiB = 1024 * KiB;
+const qint64 GiB = 1024 * MiB;
+
+// Value written over the original byte to make a difference
+const uchar diffMask = 0x5a;
+
+// Differing blocks given to view, a stale tree claims all blocks equal
+// like after a file changed on disk
+const int noTree = 0;
+const int builtTree = 1;
+const int staleTree = 2;
+
+// File of given size created with ftruncate, so everything not explicitly
+// written is a hole taking no disk space. Mapped read only while alive.
+class SparseFile
+{
+public:
+    SparseFile( const QString& fileName, const qint64 size, const QList<qint64>& written )
+        : _file( fileName ),
+          _mmap( nullptr )
+    {
+        if( !_file.open( QIODevice::ReadWrite | QIODevice::Truncate ) )
+            return;
+        if( ::ftruncate( _file.handle(), size ) != 0 )
+            return;
+        for( const qint64 offset : written ) {
+            if( offset < size && ( !_file.seek( offset ) || !_file.putChar( static_cast<char>( diffMask ) ) ) )
+                return;
+        }
+        if( _file.flush() && size > 0 )
+            _mmap = _file.map( 0, size );
+    }
+
+    ~SparseFile()
+    {
+        if( _mmap )
+            _file.unmap( _mmap );
+        _file.remove();
+    }
+
+    inline bool isValid() const { return _mmap != nullptr; }
+    inline const uchar* data() const { return _mmap; }
+    inline qint64 size() const { return _file.size(); }
+
+private: // No copying
+    SparseFile( const SparseFile& );
+    SparseFile& operator=( const SparseFile& );
+
+private: // Data
+    QFile  _file;
+    uchar* _mmap;
+};
+
+// Naive reference of BlockHashTree::differingBlocks, byte by byte
+QBitArray naiveDifferingBlocks( const uchar* data1, const qint64 size1, const uchar* data2, const qint64 size2, const int blockSize )
+{
+    const qint64 minSize = qMin( size1, size2 );
+    const qint64 maxSize = qMax( size1, size2 );
+    QBitArray bits( static_cast<int>( ( maxSize + blockSize - 1 ) / blockSize ) );
+
+    for( qint64 addr( 0 ); addr < maxSize; addr++ ) {
+        if( addr >= minSize || data1[addr] != data2[addr] )
+            bits.setBit( static_cast<int>( addr / blockSize ) );
+    }
+    return bits;
+}
+
+// Naive reference of ViewLayout::formatAddress
+QString naiveAddress( const qint64 addr, const int chars )
+{
+    QString hex = QString( "%1" ).arg( static_cast<quint64>( addr ), 16, 16, QLatin1Char( '0' ) ).toUpper().right( chars );
+    hex.insert( chars / 2, QLatin1Char( ':' ) );
+    return hex;
+}
+
+qint64 residentKiB()
+{
+    QFile statm( "/proc/self/statm" );
+    if( !statm.open( QIODevice::ReadOnly ) )
+        return -1;
+    return statm.readAll().split( ' ' ).value( 1 ).toLongLong() * sysconf( _SC_PAGESIZE ) / KiB;
+}
+
+} // namespace
+
+class TestBinDiff : public QObject
+{
+    Q_OBJECT
+
+public:
+    TestBinDiff() : QObject(), _dir(), _timer() {}
+
+private slots:
+    void initTestCase();
+    void init();
+    void cleanup();
+    void formatAddress_data();
+    void formatAddress();
+    void differingBlocks_data();
+    void differingBlocks();
+    void frameDiff_data();
+    void frameDiff();
+
+private: // Data
+    QTemporaryDir _dir;
+    QElapsedTimer _timer;
+};
+
+void TestBinDiff::initTestCase()
+{
+    QVERIFY( _dir.isValid() );
+}
+
+void TestBinDiff::init()
+{
+    _timer.start();
+}
+
+void TestBinDiff::cleanup()
+{
+    // Cost of each case, RSS counts only the pages of sparse files touched
+    struct rusage usage;
+    getrusage( RUSAGE_SELF, &usage );
+    qInfo( "%s(%s): %lld ms, RSS %lld KiB, peak RSS %ld KiB",
+           QTest::currentTestFunction(), QTest::currentDataTag() ? QTest::currentDataTag() : "",
+           _timer.elapsed(), residentKiB(), usage.ru_maxrss );
+}
+
+void TestBinDiff::formatAddress_data()
+{
+    QTest::addColumn<int>( "chars" );
+    QTest::addColumn<QList<qint64>>( "addresses" );
+
+    const QList<qint64> edges = { 0, 1, 0xffff, 0x10000, 0xffffffffLL, 4 * GiB, 4 * GiB + 1, 17 * GiB - 1,
+                                  0x123456789abcdef0LL, 0x7fffffffffffffffLL };
+    std::mt19937_64 random( 1 );
+    QList<qint64> randoms;
+    for( int n( 0 ); n < 10000; n++ )
+        randoms.append( static_cast<qint64>( random() >> 1 ) );
+
+    QTest::newRow( "8 chars edges" ) << 8 << edges;
+    QTest::newRow( "16 chars edges" ) << 16 << edges;
+    QTest::newRow( "8 chars random" ) << 8 << randoms;
+    QTest::newRow( "16 chars random" ) << 16 << randoms;
+}
+
+void TestBinDiff::formatAddress()
+{
+    QFETCH( int, chars );
+    QFETCH( QList<qint64>, addresses );
+
+    ViewLayout layout;
+    layout.setAddressCharacters( chars );
+    QCOMPARE( layout.addressCharacters(), chars );
+
+    QChar text[ViewLayout::maxTextChars];
+    for( const qint64 addr : addresses ) {
+        const int length = layout.formatAddress( text, addr );
+        QCOMPARE( QString( text, length ), naiveAddress( addr, chars ) );
+    }
+}
+
+void TestBinDiff::differingBlocks_data()
+{
+    QTest::addColumn<bool>( "sparse" );
+    QTest::addColumn<qint64>( "size1" );
+    QTest::addColumn<qint64>( "size2" );
+    QTest::addColumn<QList<qint64>>( "diffs" );    // changed offsets of the second file
+    QTest::addColumn<int>( "blockSize" );
+
+    const qint64 size = MiB + 3;
+    QTest::newRow( "equal" ) << false << size << size << QList<qint64>() << 4096;
+    QTest::newRow( "one byte" ) << false << size << size << QList<qint64>{ 500000 } << 4096;
+    QTest::newRow( "first and last byte" ) << false << size << size << QList<qint64>{ 0, size - 1 } << 4096;
+    QTest::newRow( "block edges" ) << false << size << size << QList<qint64>{ 4095, 4096, 8191 * 16 } << 4096;
+    QTest::newRow( "shorter by one" ) << false << size << size - 1 << QList<qint64>() << 4096;
+    QTest::newRow( "shorter by blocks" ) << false << size << size - 3 * 4096 - 1 << QList<qint64>() << 4096;
+    QTest::newRow( "longer and differing" ) << false << size << size + 5000 << QList<qint64>{ 7 } << 4096;
+    QTest::newRow( "tail of partial block" ) << false << 10 * 4096 + 17LL << 10 * 4096 + 17LL << QList<qint64>{ 10 * 4096 + 16 } << 4096;
+    QTest::newRow( "single block" ) << false << 100LL << 100LL << QList<qint64>{ 50 } << 4096;
+    QTest::newRow( "other empty" ) << false << size << 0LL << QList<qint64>() << 4096;
+
+    const qint64 sparseSize = 64 * MiB + 3;
+    QTest::newRow( "sparse equal" ) << true << sparseSize << sparseSize << QList<qint64>() << static_cast<int>( BlockHashTree::defaultBlockSize );
+    QTest::newRow( "sparse size mismatch" ) << true << sparseSize << sparseSize + 100 << QList<qint64>() << static_cast<int>( BlockHashTree::defaultBlockSize );
+    QTest::newRow( "sparse tail difference" ) << true << sparseSize << sparseSize << QList<qint64>{ sparseSize - 1 } << static_cast<int>( BlockHashTree::defaultBlockSize );
+}
+
+void TestBinDiff::differingBlocks()
+{
+    QFETCH( bool, sparse );
+    QFETCH( qint64, size1 );
+    QFETCH( qint64, size2 );
+    QFETCH( QList<qint64>, diffs );
+    QFETCH( int, blockSize );
+
+    const uchar* data1;
+    const uchar* data2;
+    QByteArray bytes1, bytes2;
+    QScopedPointer<SparseFile> file1, file2;
+
+    if( sparse ) {
+        file1.reset( new SparseFile( _dir.filePath( "1" ), size1, QList<qint64>() ) );
+        file2.reset( new SparseFile( _dir.filePath( "2" ), size2, diffs ) );
+        if( !file1->isValid() || !file2->isValid() )
+            QSKIP( "Sparse files can't be created or mapped here" );
+        data1 = file1->data();
+        data2 = file2->data();
+    }
+    else {
+        // Same random content in both, then differences to the second one
+        std::mt19937 random( 2 );
+        bytes1.resize( static_cast<int>( qMax( size1, size2 ) ) );
+        for( auto& b : bytes1 )
+            b = static_cast<char>( random() );
+        bytes2 = bytes1;
+        for( const qint64 offset : diffs )
+            bytes2[static_cast<int>( offset )] = static_cast<char>( bytes2.at( static_cast<int>( offset ) ) ^ diffMask );
+        data1 = reinterpret_cast<const uchar*>( bytes1.constData() );
+        data2 = reinterpret_cast<const uchar*>( bytes2.constData() );
+    }
+
+    BlockHashTree tree1, tree2;
+    tree1.build( data1, size1, blockSize );
+    tree2.build( data2, size2, blockSize );
+
+    QCOMPARE( tree1.differingBlocks( tree2 ), naiveDifferingBlocks( data1, size1, data2, size2, blockSize ) );
+    QCOMPARE( tree2.differingBlocks( tree1 ), naiveDifferingBlocks( data2, size2, data1, size1, blockSize ) );
+}
+
+void TestBinDiff::frameDiff_data()
+{
+    QTest::addColumn<qint64>( "size1" );
+    QTest::addColumn<qint64>( "size2" );
+    QTest::addColumn<QList<qint64>>( "diffs" );    // changed offsets of the second file
+    QTest::addColumn<int>( "bytesPerLine" );
+    QTest::addColumn<qint64>( "address" );         // scrolled to
+    QTest::addColumn<int>( "hashTree" );
+    QTest::addColumn<int>( "addressChars" );
+    QTest::addColumn<bool>( "multiStep" );         // lines don't fit to int scroll bar range
+
+    const qint64 size = MiB + 7;
+    const QList<qint64> edges = { 65535, 65536, 131071, size - 1 };
+    QTest::newRow( "equal" ) << size << size << QList<qint64>() << 16 << 0x8000LL << builtTree << 8 << false;
+    QTest::newRow( "block edges" ) << size << size << edges << 16 << 65500LL << noTree << 8 << false;
+    QTest::newRow( "block edges, tree" ) << size << size << edges << 16 << 65500LL << builtTree << 8 << false;
+    QTest::newRow( "stale tree" ) << size << size << edges << 16 << 65500LL << staleTree << 8 << false;
+    QTest::newRow( "size mismatch" ) << size << size + 100 << QList<qint64>() << 16 << size << noTree << 8 << false;
+    QTest::newRow( "size mismatch, tree" ) << size + 100 << size << QList<qint64>() << 16 << size << builtTree << 8 << false;
+    QTest::newRow( "tail difference" ) << size << size << QList<qint64>{ size - 1 } << 16 << size << noTree << 8 << false;
+    QTest::newRow( "tail difference, tree" ) << size << size << QList<qint64>{ size - 1 } << 16 << size << builtTree << 8 << false;
+
+    const QList<qint64> at4GiB = { 4 * GiB - 2, 4 * GiB - 1 };
+    QTest::newRow( "4GiB" ) << 4 * GiB << 4 * GiB << at4GiB << 16 << 4 * GiB << noTree << 8 << false;
+    QTest::newRow( "4GiB+1" ) << 4 * GiB + 1 << 4 * GiB << at4GiB << 16 << 4 * GiB << noTree << 16 << false;
+
+    const QList<qint64> at17GiB = { 4 * GiB, 17 * GiB - 1 };
+    QTest::newRow( "17GiB at 4GiB" ) << 17 * GiB << 17 * GiB + 5 << at17GiB << 8 << 4 * GiB << noTree << 16 << true;
+    QTest::newRow( "17GiB at end" ) << 17 * GiB << 17 * GiB + 5 << at17GiB << 8 << 17 * GiB << noTree << 16 << true;
+}
+
+void TestBinDiff::frameDiff()
+{
+    QFETCH( qint64, size1 );
+    QFETCH( qint64, size2 );
+    QFETCH( QList<qint64>, diffs );
+    QFETCH( int, bytesPerLine );
+    QFETCH( qint64, address );
+    QFETCH( int, hashTree );
+    QFETCH( int, addressChars );
+    QFETCH( bool, multiStep );
+
+    SparseFile file1( _dir.filePath( "1" ), size1, QList<qint64>() );
+    SparseFile file2( _dir.filePath( "2" ), size2, diffs );
+    if( !file1.isValid() || !file2.isValid() )
+        QSKIP( "Sparse files can't be created or mapped here" );
+
+    DualFileView view;
+    view.setFont( QFont( "Monospace", 10 ) );
+    view.resize( 800, 600 );
+    view.show();
+    QVERIFY( QTest::qWaitForWindowExposed( &view ) );
+
+    view.setBytesPerLine( bytesPerLine );
+    view.setData( 0, file1.data(), size1 );
+    view.setData( 1, file2.data(), size2 );
+    QCOMPARE( view.layout().addressCharacters(), addressChars );
+    QCOMPARE( view.bytesPerLine(), bytesPerLine );
+
+    // Scroll bar has a step per line unless lines overflow its int range
+    const qint64 maxSize = qMax( size1, size2 );
+    const qint64 lineCount = ( maxSize + bytesPerLine - 1 ) / bytesPerLine;
+    const qint64 scrollLines = lineCount - view.capacity() / bytesPerLine;
+    QCOMPARE( view.verticalScrollBar()->maximum() < scrollLines, multiStep );
+
+    QBitArray blocks;
+    if( hashTree != noTree ) {
+        BlockHashTree tree1, tree2;
+        tree1.build( file1.data(), size1 );
+        tree2.build( file2.data(), size2 );
+        blocks = tree1.differingBlocks( tree2 );
+        if( hashTree == staleTree )
+            blocks.fill( false );
+        view.setDifferingBlocks( blocks, tree1.blockSize() );
+    }
+
+    view.scrollToAddress( address );
+    view.viewport()->repaint();
+
+    // Requested line is on top, or the end of file is in view
+    const qint64 addend = view.addressAddend();
+    if( address <= maxSize - view.capacity() )
+        QCOMPARE( addend, address / bytesPerLine * bytesPerLine );
+    else
+        QVERIFY( addend + view.capacity() >= maxSize );
+
+    const qint64 minSize = qMin( size1, size2 );
+    const uchar* data1 = file1.data();
+    const uchar* data2 = file2.data();
+    const QVector<uchar>& frameDiff = view.frameDiff();
+    QCOMPARE( static_cast<qint64>( frameDiff.size() ), static_cast<qint64>( view.capacity() ) );
+    for( int c( 0 ); c < frameDiff.size(); c++ ) {
+        // Bytes the hash tree says equal aren't compared, so aren't proven equal either
+        const qint64 addr = addend + c;
+        const qint64 block = addr / BlockHashTree::defaultBlockSize;
+        uchar expected = DualFileView::Differs;
+        if( addr >= maxSize || ( block < blocks.size() && !blocks.testBit( static_cast<int>( block ) ) ) )
+            expected = DualFileView::Unchecked;
+        else if( addr < minSize && data1[addr] == data2[addr] )
+            expected = DualFileView::Equal;
+        if( frameDiff.at( c ) != expected )
+            QFAIL( qPrintable( QString( "Frame diff differs at address %1" ).arg( addr ) ) );
+    }
+}
+
+int main( int argc, char* argv[] )
+{
+    // Views are shown, also on a build server without display
+    if( qEnvironmentVariableIsEmpty( "QT_QPA_PLATFORM" ) )
+        qputenv( "QT_QPA_PLATFORM", "offscreen" );
+
+    QApplication app( argc, argv );
+    TestBinDiff test;
+    return QTest::qExec( &test, argc, argv );
+}
+
+#include "tst_bindiff.moc"
@@ -0,0 +1,277 @@
+//*****************************************************************************
+//
+//     viewlayout.cpp
+//     Copyright(c) 2016 Juha T Nikkanen <nikkej@gmail.com>
+//
+// --- Legal stuff ---
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//*****************************************************************************
+
+#include "viewlayout.h"
+
+#include <QFontMetrics>
+#include <cstring>
+
+namespace {
+
+const char hexDigits[] = "0123456789ABCDEF";
+
+const char* const binaryNibbles[16] = {
+    "0000", "0001", "0010", "0011", "0100", "0101", "0110", "0111",
+    "1000", "1001", "1010", "1011", "1100", "1101", "1110", "1111"
+};
+
+// Indexed by ViewLayout::DisplayUnit
+const struct {
+    int bytes;
+    int chars;
+} cellFormats[] = {
+    { 1,  2 },      // HexBytes
+    { 2,  4 },      // HexWords16
+    { 4,  8 },      // HexWords32
+    { 8, 16 },      // HexWords64
+    { 4, 13 },      // Floats32, "%.7g" of e.g. -1.175494e-38
+    { 8, 23 },      // Floats64, "%.16g" of e.g. -2.225073858507201e-308
+    { 1,  8 }       // BinaryBytes
+};
+
+inline void writeHexByte( QChar* out, const uchar byte )
+{
+    out[0] = QLatin1Char( hexDigits[byte >> 4] );
+    out[1] = QLatin1Char( hexDigits[byte & 0xf] );
+}
+
+inline void writeHexDigits( QChar* out, quint64 value, const int digits )
+{
+    for( int d( digits - 1 ); d >= 0; d--, value >>= 4 )
+        out[d] = QLatin1Char( hexDigits[value & 0xf] );
+}
+
+} // namespace
+
+ViewLayout::ViewLayout()
+    : _addressChars( 8 ),
+      _groupSetting( ViewLayout::defaultBytesPerGroup ),
+      _lineSetting( 0 ),
+      _unit( ViewLayout::HexBytes ),
+      _endianness( ViewLayout::LittleEndian ),
+      _bytesPerGroup( ViewLayout::defaultBytesPerGroup ),
+      _byteGroups( ViewLayout::minimumBytesPerLine / ViewLayout::defaultBytesPerGroup ),
+      _fitWidth( 0 ),
+      _font(),
+      _metricsValid( false ),
+      _lineHeight( 0 ),
+      _charWidth( 0 ),
+      _digitWidth( 0 ),
+      _leftMargin( 0 ),
+      _rightMargin( 0 ),
+      _bottomMargin( 0 ),
+      _cellWidth( 0 ),
+      _groupWidth( 0 ),
+      _groupGap( 0 ),
+      _addressAreaWidth( 0 ),
+      _hexAreaWidth( 0 ),
+      _asciiAreaWidth( 0 )
+{
+}
+
+bool ViewLayout::setFont( const QFont& font )
+{
+    if( _metricsValid && font == _font )
+        return false;
+
+    QFontMetrics metrics( font );
+    _font = font;
+    _metricsValid = true;
+    _lineHeight = metrics.height();
+    _charWidth = metrics.averageCharWidth();
+    _digitWidth = metrics.width( QLatin1Char( '0' ) );
+
+    updateMeasures();
+    return true;
+}
+
+void ViewLayout::setAddressCharacters( const int chars )
+{
+    _addressChars = chars;
+    if( _addressChars & 1 )
+        _addressChars++;
+
+    updateMeasures();
+}
+
+void ViewLayout::setBytesPerGroup( const int bytes )
+{
+    _groupSetting = qMax( 1, bytes );
+    updateMeasures();
+}
+
+void ViewLayout::setBytesPerLine( const int bytes )
+{
+    _lineSetting = qMax( 0, bytes );
+    updateMeasures();
+}
+
+void ViewLayout::setDisplayUnit( const DisplayUnit unit )
+{
+    _unit = unit;
+    updateMeasures();
+}
+
+void ViewLayout::setEndianness( const Endianness endianness )
+{
+    _endianness = endianness;
+}
+
+void ViewLayout::fitToWidth( const int width )
+{
+    _fitWidth = width;
+
+    if( _lineSetting ) {
+        // Lines hold whole groups, a line shorter than or not divisible by
+        // the group is rounded up to the next multiple of it
+        setByteGroups( qMax( 1, ( _lineSetting + _bytesPerGroup - 1 ) / _bytesPerGroup ) );
+        return;
+    }
+
+    // preFitWidth( groups ) <= width, solved for groups
+    int perGroup = _groupWidth + _groupGap + _bytesPerGroup * _charWidth;
+    int fixed = _addressAreaWidth - _groupGap + _leftMargin + 2 * _rightMargin;
+    int groups = perGroup > 0 ? ( width - fixed ) / perGroup : 0;
+
+    setByteGroups( qMax( groups, minimumOfByteGroups() ) );
+}
+
+int ViewLayout::preFitWidth( const int byteGroups ) const
+{
+    int newHexAreaWidth = byteGroups * _groupWidth + (byteGroups - 1) * _groupGap + _rightMargin;
+    int newAsciiAreaWidth = byteGroups * _bytesPerGroup * _charWidth + _leftMargin + _rightMargin;
+    return( _addressAreaWidth + newHexAreaWidth + newAsciiAreaWidth );
+}
+
+int ViewLayout::formatAddress( QChar* out, const qint64 addr ) const
+{
+    // Drawn like %0nX:%0nX where n is _addressChars / 2
+    const int digits = _addressChars / 2;
+    const quint64 value = static_cast<quint64>( addr );
+
+    writeHexDigits( out, value >> ( 4 * digits ), digits );
+    out[digits] = QLatin1Char( ':' );
+    writeHexDigits( out + digits + 1, value, digits );
+
+    return _addressChars + 1;
+}
+
+int ViewLayout::formatCell( QChar* out, const uchar* data, const int bytes ) const
+{
+    const int n = cellBytes();
+    const int chars = cellChars();
+
+    if( bytes < n ) {
+        // Partial cell at the end of data, show what there is as plain bytes
+        for( int c( 0 ); c < chars; c++ )
+            out[c] = QLatin1Char( ' ' );
+        for( int b( 0 ); b < bytes && 2 * b + 1 < chars; b++ )
+            writeHexByte( out + 2 * b, data[b] );
+        return chars;
+    }
+
+    switch( _unit ) {
+    case ViewLayout::HexBytes:
+        writeHexByte( out, *data );
+        break;
+    case ViewLayout::HexWords16:
+    case ViewLayout::HexWords32:
+    case ViewLayout::HexWords64:
+        // Most significant byte first
+        for( int b( 0 ); b < n; b++ )
+            writeHexByte( out + 2 * b, data[_endianness == ViewLayout::BigEndian ? b : n - 1 - b] );
+        break;
+    case ViewLayout::Floats32:
+    case ViewLayout::Floats64: {
+        const bool hostOrder = ( _endianness == ViewLayout::BigEndian ) == ( Q_BYTE_ORDER == Q_BIG_ENDIAN );
+        uchar raw[8];
+        for( int b( 0 ); b < n; b++ )
+            raw[b] = data[hostOrder ? b : n - 1 - b];
+
+        char text[ViewLayout::maxTextChars];
+        int length;
+        if( _unit == ViewLayout::Floats32 ) {
+            float value;
+            std::memcpy( &value, raw, sizeof( value ) );
+            length = qsnprintf( text, sizeof( text ), "%*.7g", chars, static_cast<double>( value ) );
+        }
+        else {
+            double value;
+            std::memcpy( &value, raw, sizeof( value ) );
+            length = qsnprintf( text, sizeof( text ), "%*.16g", chars, value );
+        }
+        length = qBound( 0, length, chars );
+        for( int c( 0 ); c < length; c++ )
+            out[c] = QLatin1Char( text[c] );
+        return length;
+    }
+    case ViewLayout::BinaryBytes:
+        for( int c( 0 ); c < 4; c++ ) {
+            out[c] = QLatin1Char( binaryNibbles[*data >> 4][c] );
+            out[c + 4] = QLatin1Char( binaryNibbles[*data & 0xf][c] );
+        }
+        break;
+    }
+
+    return chars;
+}
+
+int ViewLayout::cellBytes() const
+{
+    return cellFormats[_unit].bytes;
+}
+
+int ViewLayout::cellChars() const
+{
+    return cellFormats[_unit].chars;
+}
+
+void ViewLayout::updateMeasures()
+{
+    // Set side margins to half of a character width,
+    // bottom margin half of font height
+    _leftMargin = _charWidth / 2;
+    _rightMargin = _leftMargin;
+    _bottomMargin = _lineHeight / 2;
+    _groupGap = _charWidth;
+    _cellWidth = cellChars() * _digitWidth + _leftMargin;
+    _addressAreaWidth = ( _addressChars + 1 ) * _digitWidth + _leftMargin + _rightMargin;
+
+    // Group holds whole cells only
+    _bytesPerGroup = ( ( qMax( _groupSetting, cellBytes() ) + cellBytes() - 1 ) / cellBytes() ) * cellBytes();
+    _groupWidth = ( _bytesPerGroup / cellBytes() ) * _cellWidth;
+
+    fitToWidth( _fitWidth );
+}
+
+void ViewLayout::setByteGroups( const int byteGroups )
+{
+    _byteGroups = byteGroups;
+    _hexAreaWidth = _byteGroups * _groupWidth + (_byteGroups - 1) * _groupGap + _rightMargin;
+    _asciiAreaWidth = bytesPerLine() * _charWidth + _leftMargin + _rightMargin;
+}
+
+int ViewLayout::minimumOfByteGroups() const
+{
+    return qMax( 1, ViewLayout::minimumBytesPerLine / _bytesPerGroup );
+}
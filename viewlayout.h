@@ -0,0 +1,135 @@
+//*****************************************************************************
+//
+//     viewlayout.h
+//     Copyright(c) 2016 Juha T Nikkanen <nikkej@gmail.com>
+//
+// --- Legal stuff ---
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU Lesser General Public
+// License as published by the Free Software Foundation; either
+// version 2.1 of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public
+// License along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+//*****************************************************************************
+
+#ifndef VIEWLAYOUT_H
+#define VIEWLAYOUT_H
+
+#include <QFont>
+
+class QChar;
+
+// Data layout & pixel measures of a hex view. Line is made of byte groups,
+// group of cells and cell of one displayed unit (byte, word, float...).
+// Font metrics are cached per font and # of groups fitting into given width
+// is solved in closed form, so resizing or switching display mode is cheap.
+class ViewLayout
+{
+public:
+    enum DisplayUnit {
+        HexBytes,
+        HexWords16,
+        HexWords32,
+        HexWords64,
+        Floats32,
+        Floats64,
+        BinaryBytes
+    };
+
+    enum Endianness {
+        LittleEndian,
+        BigEndian
+    };
+
+    enum Constants {
+        defaultBytesPerGroup = 4,
+        minimumBytesPerLine = 16,
+        maxTextChars = 32          // enough for any cell or address text
+    };
+
+    ViewLayout();
+
+    bool setFont( const QFont& );
+    void setAddressCharacters( const int );
+    void setBytesPerGroup( const int );
+    void setBytesPerLine( const int );
+    void setDisplayUnit( const DisplayUnit );
+    void setEndianness( const Endianness );
+    void fitToWidth( const int );
+    int preFitWidth( const int ) const;
+
+    // Text formatting into caller's buffer of maxTextChars,
+    // returns # of characters written
+    int formatAddress( QChar*, const qint64 ) const;
+    int formatCell( QChar*, const uchar*, const int ) const;
+
+    inline int addressCharacters() const { return _addressChars; }
+    inline int bytesPerGroupSetting() const { return _groupSetting; }
+    inline int bytesPerLineSetting() const { return _lineSetting; }
+    inline DisplayUnit displayUnit() const { return _unit; }
+    inline Endianness endianness() const { return _endianness; }
+
+    inline int byteGroups() const { return _byteGroups; }
+    inline int bytesPerGroup() const { return _bytesPerGroup; }
+    inline int bytesPerLine() const { return _byteGroups * _bytesPerGroup; }
+    int cellBytes() const;
+    int cellChars() const;
+    int minimumOfByteGroups() const;
+
+    inline int lineHeight() const { return _lineHeight; }
+    inline int charWidth() const { return _charWidth; }
+    inline int leftMargin() const { return _leftMargin; }
+    inline int rightMargin() const { return _rightMargin; }
+    inline int bottomMargin() const { return _bottomMargin; }
+    inline int cellWidth() const { return _cellWidth; }
+    inline int groupGap() const { return _groupGap; }
+    inline int addressAreaWidth() const { return _addressAreaWidth; }
+    inline int hexAreaWidth() const { return _hexAreaWidth; }
+    inline int asciiAreaWidth() const { return _asciiAreaWidth; }
+
+private: // Methods
+    void updateMeasures();
+    void setByteGroups( const int );
+
+private: // Data
+    // Settings
+    int           _addressChars;       // # of characters on address field
+    int           _groupSetting;       // requested bytes per group
+    int           _lineSetting;        // requested bytes per line, 0 == fit to width
+    DisplayUnit   _unit;
+    Endianness    _endianness;
+
+    // Derived layout
+    int           _bytesPerGroup;      // _groupSetting rounded up to whole cells
+    int           _byteGroups;
+    int           _fitWidth;           // width last fitted to
+
+    // Font metrics, valid for _font
+    QFont         _font;
+    bool          _metricsValid;
+    int           _lineHeight;
+    int           _charWidth;
+    int           _digitWidth;
+
+    // Pixel measures
+    int     _leftMargin;
+    int     _rightMargin;
+    int     _bottomMargin;
+    int     _cellWidth;
+    int     _groupWidth;
+    int     _groupGap;
+    int     _addressAreaWidth;
+    int     _hexAreaWidth;
+    int     _asciiAreaWidth;
+};
+
+#endif // VIEWLAYOUT_H